@@ -4,7 +4,7 @@
 #
 function __get_commands()
 {
-  echo "annotate cancel config continue day delete diagnostics export extensions gaps get help join lengthen modify month move report resize shorten show split start stop summary tag tags track undo untag week"
+  echo "annotate cancel config continue day delete diagnostics export extensions gaps get help join lengthen modify month move report resize shorten show split start stop summary tag tags track undo untag week year"
 }
 
 function __get_subcommands()
@@ -130,7 +130,7 @@ function _timew()
   first="${COMP_WORDS[1]}"
 
   case "${first}" in
-    cancel|config|diagnostics|day|extensions|get|month|show|undo|week)
+    cancel|config|diagnostics|day|extensions|get|month|show|undo|week|year)
       wordlist=""
       ;;
     annotate|continue|delete|join|lengthen|move|resize|shorten|split)
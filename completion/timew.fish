@@ -73,6 +73,7 @@ tags\t'Display a list of tags'
 track\t'Add intervals to the database'
 untag\t'Remove tags from intervals'
 week\t'Display chart report'
+year\t'Display chart report'
 "
 
 # Base Commands 
@@ -189,6 +190,10 @@ complete -c timew -n "__fish_seen_subcommand_from week" \
   -a "$tags $intervals"
 # [<interval>] [<tag> ...]
 
+complete -c timew -n "__fish_seen_subcommand_from year" \
+  -a "$tags $intervals"
+# [<interval>] [<tag> ...]
+
 complete -c timew -n "__fish_seen_subcommand_from help" \
   -a "$commands dates dom durations hints ranges" \
   -d "Show help"
@@ -26,17 +26,348 @@
 
 #include <AtomicFile.h>
 #include <FS.h>
+#include <algorithm>
 #include <cassert>
 #include <cerrno>
 #include <csignal>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <fcntl.h>
 #include <format.h>
 #include <iostream>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
 #include <timew.h>
 #include <unistd.h>
+#include <utility>
 #include <vector>
 
+#ifdef __linux__
+#include <linux/fs.h>
+#endif
+
+namespace
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// While the end of a file is replaced in place, the original end is kept in a
+// rollback record next to it: the original size on the first line, followed
+// by the original bytes from the replaced offset on.
+std::string rollbackPath (const std::string& path)
+{
+  return path + ".rollback";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool readAt (int fd, char* data, size_t size, off_t offset)
+{
+  while (size > 0)
+  {
+    auto count = ::pread (fd, data, size, offset);
+    if (count <= 0)
+    {
+      if (count == -1 && errno == EINTR)
+      {
+        continue;
+      }
+
+      return false;
+    }
+
+    data += count;
+    size -= count;
+    offset += count;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Returns the number of bytes written, which is less than size on failure.
+size_t writeAt (int fd, const char* data, size_t size, off_t offset)
+{
+  size_t written = 0;
+  while (written < size)
+  {
+    auto count = ::pwrite (fd, data + written, size - written, offset + written);
+    if (count == -1)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+
+      break;
+    }
+
+    written += count;
+  }
+
+  return written;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Puts back the first length bytes of the original end of a file, which start
+// at size - tail.size (), and cuts off anything beyond the original size.
+bool restoreTail (int fd, size_t size, const std::string& tail, size_t length)
+{
+  length = std::min (length, tail.size ());
+  return writeAt (fd, tail.data (), length, size - tail.size ()) == length &&
+         ::ftruncate (fd, size) == 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The modification time in nanoseconds, as MappedFile and DatafileIndex have
+// it.
+int64_t modificationTime (const struct stat& s)
+{
+#ifdef __APPLE__
+  return static_cast <int64_t> (s.st_mtimespec.tv_sec) * 1000000000 + s.st_mtimespec.tv_nsec;
+#else
+  return static_cast <int64_t> (s.st_mtim.tv_sec) * 1000000000 + s.st_mtim.tv_nsec;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Copies the open file in, whose status is s, to a new file at to. Where the
+// file system supports it, the copy shares its blocks with the original, or is
+// done by the kernel. Otherwise the content is read and written in turn.
+bool cloneFile (int in, const struct stat& s, const std::string& to)
+{
+  int out = ::open (to.c_str (), O_WRONLY | O_CREAT | O_TRUNC, s.st_mode & 07777);
+  if (out == -1)
+  {
+    return false;
+  }
+
+  bool ok = false;
+
+#ifdef FICLONE
+  ok = ::ioctl (out, FICLONE, in) == 0;
+#endif
+
+  off_t copied = 0;
+
+#if defined (__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+  while (! ok)
+  {
+    auto count = ::copy_file_range (in, nullptr, out, nullptr, s.st_size - copied, 0);
+    if (count == -1 && errno == EINTR)
+    {
+      continue;
+    }
+
+    if (count <= 0)
+    {
+      break;
+    }
+
+    copied += count;
+    ok = copied == s.st_size;
+  }
+#endif
+
+  // Plain reads and writes, for file systems and kernels without either.
+  char buffer[65536];
+  while (! ok)
+  {
+    auto count = ::pread (in, buffer, sizeof (buffer), copied);
+    if (count == -1 && errno == EINTR)
+    {
+      continue;
+    }
+
+    if (count <= 0)
+    {
+      ok = count == 0;
+      break;
+    }
+
+    if (writeAt (out, buffer, count, copied) != static_cast <size_t> (count))
+    {
+      break;
+    }
+
+    copied += count;
+  }
+
+  return (::close (out) == 0) && ok;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool cloneFile (const std::string& from, const std::string& to)
+{
+  int in = ::open (from.c_str (), O_RDONLY);
+  if (in == -1)
+  {
+    return false;
+  }
+
+  struct stat s;
+  bool ok = ::fstat (in, &s) == 0 && cloneFile (in, s, to);
+  ::close (in);
+  return ok;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string parentDirectory (const std::string& path)
+{
+  auto slash = path.rfind ('/');
+  if (slash == std::string::npos)
+  {
+    return ".";
+  }
+
+  return slash == 0 ? "/" : path.substr (0, slash);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Flushes files to the device as a group. Writeback is started for all of
+// them first, so that the fsync of each file mostly waits for I/O that is
+// already in flight, instead of the files being written one after another.
+// Some file systems do not support fsync, on directories in particular, which
+// is not an error.
+bool syncFiles (const std::vector <std::string>& paths)
+{
+  bool ok = true;
+  std::vector <int> fds;
+
+  for (auto& path : paths)
+  {
+    int fd = ::open (path.c_str (), O_RDONLY);
+    if (fd == -1)
+    {
+      ok = false;
+      continue;
+    }
+
+#ifdef SYNC_FILE_RANGE_WRITE
+    ::sync_file_range (fd, 0, 0, SYNC_FILE_RANGE_WRITE);
+#endif
+    fds.push_back (fd);
+  }
+
+  for (auto fd : fds)
+  {
+    if (::fsync (fd) && errno != EINVAL && errno != ENOTSUP && errno != EOPNOTSUPP)
+    {
+      ok = false;
+    }
+
+    ::close (fd);
+  }
+
+  return ok;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Makes renames, new files and removals in the directories of the given paths
+// durable, syncing each directory once.
+bool syncDirectories (const std::vector <std::string>& paths)
+{
+  std::vector <std::string> directories;
+  for (auto& path : paths)
+  {
+    directories.push_back (parentDirectory (path));
+  }
+
+  std::sort (directories.begin (), directories.end ());
+  directories.erase (std::unique (directories.begin (), directories.end ()), directories.end ());
+
+  return syncFiles (directories);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Writes a group of files, each of which is either complete or missing after a
+// crash, and syncs them together. Where O_TMPFILE is available, the content is
+// written to unnamed files that are only linked into place once they are
+// synced, so that no temporary files are left behind. Otherwise, or if the
+// name is taken, each file is written under a temporary name and renamed.
+bool writeDurably (const std::vector <std::pair <std::string, std::string>>& files)
+{
+  struct Pending
+  {
+    std::string path;
+    std::string temp;
+    int fd;
+  };
+
+  bool ok = true;
+  std::vector <Pending> pending;
+
+  for (auto& file : files)
+  {
+    Pending entry {file.first, "", -1};
+#ifdef O_TMPFILE
+    entry.fd = ::open (parentDirectory (entry.path).c_str (), O_TMPFILE | O_WRONLY, 0600);
+#endif
+    if (entry.fd == -1)
+    {
+      entry.temp = entry.path + ".tmp";
+      entry.fd = ::open (entry.temp.c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    }
+
+    if (entry.fd == -1)
+    {
+      ok = false;
+      break;
+    }
+
+    pending.push_back (entry);
+    if (writeAt (entry.fd, file.second.data (), file.second.size (), 0) != file.second.size ())
+    {
+      ok = false;
+      break;
+    }
+
+#ifdef SYNC_FILE_RANGE_WRITE
+    ::sync_file_range (entry.fd, 0, 0, SYNC_FILE_RANGE_WRITE);
+#endif
+  }
+
+  for (auto& entry : pending)
+  {
+    if (ok && ::fsync (entry.fd))
+    {
+      ok = false;
+    }
+  }
+
+  for (auto& entry : pending)
+  {
+    if (ok && entry.temp.empty ())
+    {
+      auto proc = "/proc/self/fd/" + std::to_string (entry.fd);
+      if (::linkat (AT_FDCWD, proc.c_str (), AT_FDCWD, entry.path.c_str (), AT_SYMLINK_FOLLOW) != 0)
+      {
+        entry.temp = entry.path + ".tmp";
+        std::remove (entry.temp.c_str ());
+        ok = ::linkat (AT_FDCWD, proc.c_str (), AT_FDCWD, entry.temp.c_str (), AT_SYMLINK_FOLLOW) == 0;
+      }
+    }
+
+    if (::close (entry.fd))
+    {
+      ok = false;
+    }
+
+    if (! entry.temp.empty ())
+    {
+      if (! ok || std::rename (entry.temp.c_str (), entry.path.c_str ()))
+      {
+        std::remove (entry.temp.c_str ());
+        ok = false;
+      }
+    }
+  }
+
+  return ok;
+}
+
+}
+
+
 struct AtomicFile::impl
 {
   using value_type = std::shared_ptr <AtomicFile::impl>;
@@ -51,6 +382,20 @@ struct AtomicFile::impl
   // the temp file until finalization.
   bool is_temp_active {false};
 
+  // A pending replacement of everything after tail_offset in the real file,
+  // which is applied in place on finalization. The real file is expected to
+  // still have real_size then.
+  bool is_tail_active {false};
+  size_t tail_offset {0};
+  size_t real_size {0};
+  std::string tail {};
+
+  // While the tail is replaced, the real file is open and the original tail
+  // is kept, in memory and in the rollback record.
+  int tail_fd {-1};
+  std::string old_tail {};
+  bool keep_rollback {false};
+
   explicit impl (const Path& path);
   ~impl ();
 
@@ -67,9 +412,16 @@ struct AtomicFile::impl
   void read (std::vector <std::string>& lines);
   void append (const std::string& content);
   void write_raw (const std::string& content);
+  void replace_tail (size_t offset, const std::string& content);
+  bool copy_with_tail (size_t offset, const std::string& content, uint64_t size, int64_t mtime);
 
   void finalize ();
 
+  void prepare_tail ();
+  bool apply_tail ();
+  void restore_tail ();
+  void release_tail ();
+
   static atomic_files_t::iterator find (const std::string& path) = delete;
   static atomic_files_t::iterator find (const Path& path);
 
@@ -163,6 +515,11 @@ void AtomicFile::impl::close ()
 ////////////////////////////////////////////////////////////////////////////////
 size_t AtomicFile::impl::size () const
 {
+  if (is_tail_active)
+  {
+    return tail_offset + tail.size ();
+  }
+
   struct stat s;
   const char *filename = (is_temp_active) ? temp_file._data.c_str () : real_file._data.c_str ();
   if (stat (filename, &s))
@@ -179,6 +536,7 @@ void AtomicFile::impl::truncate ()
   {
     temp_file.truncate ();
     is_temp_active = true;
+    is_tail_active = false;
   }
   catch (...)
   {
@@ -194,6 +552,7 @@ void AtomicFile::impl::remove ()
   {
     temp_file.remove ();
     is_temp_active = true;
+    is_tail_active = false;
   }
   catch (...)
   {
@@ -210,6 +569,13 @@ void AtomicFile::impl::read (std::string& content)
     // Close the file before reading it in order to flush any buffers.
     temp_file.close ();
   }
+  else if (is_tail_active)
+  {
+    real_file.read (content);
+    content.resize (std::min (content.size (), tail_offset));
+    content += tail;
+    return;
+  }
   return (is_temp_active) ? temp_file.read (content) :
                             real_file.read (content);
 }
@@ -222,6 +588,26 @@ void AtomicFile::impl::read (std::vector <std::string>& lines)
     // Close the file before reading it in order to flush any buffers.
     temp_file.close ();
   }
+  else if (is_tail_active)
+  {
+    std::string content;
+    read (content);
+
+    lines.clear ();
+    std::string::size_type start = 0;
+    while (start < content.size ())
+    {
+      auto eol = content.find ('\n', start);
+      if (eol == std::string::npos)
+      {
+        eol = content.size ();
+      }
+
+      lines.push_back (content.substr (start, eol - start));
+      start = eol + 1;
+    }
+    return;
+  }
   return (is_temp_active) ? temp_file.read (lines) :
                             real_file.read (lines);
 }
@@ -231,11 +617,19 @@ void AtomicFile::impl::append (const std::string& content)
 {
   try
   {
+    if (is_tail_active)
+    {
+      tail += content;
+      return;
+    }
+
     if (!is_temp_active)
     {
       is_temp_active = true;
 
-      if (real_file.exists () && ! File::copy (real_file, temp_file))
+      // The temp file is a clone of an existing file, which is renamed over
+      // it on finalization, so that readers never see a partial append.
+      if (real_file.exists () && ! cloneFile (real_file._data, temp_file._data))
       {
         throw format ("Failed to copy '{1}' to '{2}'",
                       real_file.name (), temp_file.name ());
@@ -257,6 +651,7 @@ void AtomicFile::impl::write_raw (const std::string& content)
   {
     temp_file.write_raw (content);
     is_temp_active = true;
+    is_tail_active = false;
   }
   catch (...)
   {
@@ -265,6 +660,115 @@ void AtomicFile::impl::write_raw (const std::string& content)
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Only the new end of the file is kept until finalization. The start of the
+// file is neither copied nor written.
+void AtomicFile::impl::replace_tail (size_t offset, const std::string& content)
+{
+  assert (!is_temp_active);
+
+  try
+  {
+    struct stat s;
+    if (stat (real_file._data.c_str (), &s))
+    {
+      throw format ("stat error {1}: {2}", errno, strerror (errno));
+    }
+
+    if (offset > static_cast <size_t> (s.st_size))
+    {
+      throw format ("Offset {1} is beyond the end of '{2}'", offset, real_file._data);
+    }
+
+    real_size = s.st_size;
+    tail_offset = offset;
+    tail = content;
+    is_tail_active = true;
+  }
+  catch (...)
+  {
+    allow_atomics = false;
+    throw;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The temp file is a clone of the real file, with the new end written over
+// its end right away. The real file is unchanged until finalization, so a
+// repeated call starts over from it.
+bool AtomicFile::impl::copy_with_tail (
+  size_t offset,
+  const std::string& content,
+  uint64_t size,
+  int64_t mtime)
+{
+  try
+  {
+    // The file that is checked is the one that is cloned, even if another
+    // process renames a new file over it in the meantime.
+    int in = ::open (real_file._data.c_str (), O_RDONLY);
+    if (in == -1)
+    {
+      throw format ("Could not open '{1}': {2}", real_file._data, strerror (errno));
+    }
+
+    struct stat s;
+    if (::fstat (in, &s))
+    {
+      ::close (in);
+      throw format ("stat error {1}: {2}", errno, strerror (errno));
+    }
+
+    if (static_cast <uint64_t> (s.st_size) != size ||
+        modificationTime (s) != mtime)
+    {
+      ::close (in);
+      return false;
+    }
+
+    if (offset > static_cast <size_t> (s.st_size))
+    {
+      ::close (in);
+      throw format ("Offset {1} is beyond the end of '{2}'", offset, real_file._data);
+    }
+
+    temp_file.close ();
+    is_temp_active = true;
+    is_tail_active = false;
+
+    bool cloned = cloneFile (in, s, temp_file._data);
+    ::close (in);
+
+    if (! cloned)
+    {
+      throw format ("Failed to copy '{1}' to '{2}'",
+                    real_file.name (), temp_file.name ());
+    }
+
+    int fd = ::open (temp_file._data.c_str (), O_WRONLY);
+    bool ok = fd != -1 &&
+              writeAt (fd, content.data (), content.size (), offset) == content.size () &&
+              ::ftruncate (fd, offset + content.size ()) == 0;
+
+    if (fd != -1 && ::close (fd))
+    {
+      ok = false;
+    }
+
+    if (! ok)
+    {
+      throw format ("Failed to write '{1}'.", temp_file._data);
+    }
+  }
+  catch (...)
+  {
+    allow_atomics = false;
+    throw;
+  }
+
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void AtomicFile::impl::finalize ()
 {
@@ -288,6 +792,73 @@ void AtomicFile::impl::finalize ()
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// The end of the real file is saved in a rollback record before it is
+// overwritten. If the update is interrupted, AtomicFile::recover restores the
+// original file from the record.
+void AtomicFile::impl::prepare_tail ()
+{
+  tail_fd = ::open (real_file._data.c_str (), O_RDWR);
+  if (tail_fd == -1)
+  {
+    throw format ("Failed to open '{1}' for writing.", real_file._data);
+  }
+
+  struct stat s;
+  old_tail.assign (real_size - tail_offset, '\0');
+  if (::fstat (tail_fd, &s) ||
+      static_cast <size_t> (s.st_size) != real_size ||
+      ! readAt (tail_fd, &old_tail[0], old_tail.size (), tail_offset))
+  {
+    throw format ("'{1}' was modified while it was being updated.", real_file._data);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// If the new tail cannot be written completely, whatever was written is undone
+// right away.
+bool AtomicFile::impl::apply_tail ()
+{
+  debug (format ("Replacing '{1}' from offset {2}", real_file._data, tail_offset));
+
+  auto written = writeAt (tail_fd, tail.data (), tail.size (), tail_offset);
+  if (written == tail.size () &&
+      ::ftruncate (tail_fd, tail_offset + tail.size ()) == 0)
+  {
+    return true;
+  }
+
+  keep_rollback = ! restoreTail (tail_fd, real_size, old_tail, written);
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void AtomicFile::impl::restore_tail ()
+{
+  keep_rollback = ! restoreTail (tail_fd, real_size, old_tail, old_tail.size ());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Removes the rollback record, unless the original file could not be restored
+// after a failure, in which case it is left for AtomicFile::recover.
+void AtomicFile::impl::release_tail ()
+{
+  if (tail_fd != -1)
+  {
+    ::close (tail_fd);
+    tail_fd = -1;
+
+    if (! keep_rollback)
+    {
+      std::remove (rollbackPath (real_file._data).c_str ());
+    }
+  }
+
+  old_tail.clear ();
+  keep_rollback = false;
+  is_tail_active = false;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 AtomicFile::AtomicFile (const Path& path)
 {
@@ -401,6 +972,35 @@ void AtomicFile::write_raw (const std::string& content)
   pimpl->write_raw (content);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Replaces everything from offset to the end of the file with content. Unlike
+// the other modifications, the file is changed in place on finalization, so
+// this is meant for small changes at the end of large files. A reader of the
+// file at that time may see the change half done, which is why files that are
+// memory mapped by MappedFile must not be changed this way.
+void AtomicFile::replace_tail (size_t offset, const std::string& content)
+{
+  pimpl->replace_tail (offset, content);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Replaces everything from offset to the end of the file with content, in a
+// copy of the file that is renamed over it on finalization. The start of the
+// file is cloned where the file system supports it, or copied by the kernel,
+// and otherwise read and written.
+//
+// The offset is only meaningful for the file as it was read, so nothing is
+// done, and false returned, unless the file still has the given size and
+// modification time.
+bool AtomicFile::copy_with_tail (
+  size_t offset,
+  const std::string& content,
+  uint64_t size,
+  int64_t mtime)
+{
+  return pimpl->copy_with_tail (offset, content, size, mtime);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void AtomicFile::write (const Path& path, const std::string& data)
 {
@@ -431,6 +1031,60 @@ void AtomicFile::read (const Path& path, std::vector <std::string>& lines)
   AtomicFile (path).read (lines);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// recover - Rolls back an in-place update of path that was interrupted. Returns
+// whether there was one.
+bool AtomicFile::recover (const Path& path)
+{
+  auto record = rollbackPath (path._data);
+
+  int record_fd = ::open (record.c_str (), O_RDONLY);
+  if (record_fd == -1)
+  {
+    return false;
+  }
+
+  struct stat s;
+  std::string content;
+  if (::fstat (record_fd, &s) == 0)
+  {
+    content.resize (s.st_size);
+  }
+
+  bool ok = readAt (record_fd, &content[0], content.size (), 0);
+  ::close (record_fd);
+
+  auto eol = content.find ('\n');
+  if (! ok || eol == std::string::npos)
+  {
+    throw format ("Invalid rollback record '{1}'.", record);
+  }
+
+  auto size = strtoull (content.substr (0, eol).c_str (), nullptr, 10);
+  auto tail = content.substr (eol + 1);
+  if (tail.size () > size)
+  {
+    throw format ("Invalid rollback record '{1}'.", record);
+  }
+
+  // Without the file, there is nothing left to roll back.
+  int fd = ::open (path._data.c_str (), O_RDWR);
+  if (fd != -1)
+  {
+    ok = restoreTail (fd, size, tail, tail.size ());
+    ::close (fd);
+
+    if (! ok)
+    {
+      throw format ("Failed to roll back '{1}'. Database corruption possible.", path._data);
+    }
+  }
+
+  debug (format ("Rolled back interrupted update of '{1}'", path._data));
+  std::remove (record.c_str ());
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // finalize_all - Close / Flush all temporary files and rename to final.
 void AtomicFile::finalize_all ()
@@ -448,20 +1102,127 @@ void AtomicFile::finalize_all ()
     file->close ();
   }
 
+  // All files that are written, renamed or removed below, and their temp
+  // files. Everything is synced as a group: the temp files before any file is
+  // changed, and each directory once at the end.
+  std::vector <std::string> temps;
+  std::vector <std::string> changed;
+  for (auto& file : impl::atomic_files)
+  {
+    if (file->is_temp_active)
+    {
+      if (file->temp_file.exists ())
+      {
+        temps.push_back (file->temp_file._data);
+      }
+
+      changed.push_back (file->real_file._data);
+    }
+    else if (file->is_tail_active)
+    {
+      changed.push_back (file->real_file._data);
+    }
+  }
+
+  if (! syncFiles (temps))
+  {
+    throw std::string {"Unable to update database."};
+  }
+
+  // Step 2: Save rollback records for the files that are updated in place.
+  // Writing them may fail just like writing the temp files, in which case no
+  // file has been changed yet.
+  try
+  {
+    std::vector <std::pair <std::string, std::string>> records;
+    for (auto& file : impl::atomic_files)
+    {
+      if (file->is_tail_active)
+      {
+        file->prepare_tail ();
+        records.emplace_back (rollbackPath (file->real_file._data),
+                              std::to_string (file->real_size) + '\n' + file->old_tail);
+      }
+    }
+
+    // The records must be on the device before any file is changed.
+    if (! records.empty () &&
+        (! writeDurably (records) || ! syncDirectories (changed)))
+    {
+      throw std::string {"Failed to save rollback records."};
+    }
+  }
+  catch (...)
+  {
+    for (auto& file : impl::atomic_files)
+    {
+      file->release_tail ();
+    }
+
+    throw;
+  }
 
   sigset_t new_mask;
   sigset_t old_mask;
   sigfillset (&new_mask);
-
-  // Step 2: Rename the temp files to the *real* file
   sigprocmask (SIG_SETMASK, &new_mask, &old_mask);
+
+  // Step 3: Update files in place. This comes before any rename, so that a
+  // failure can still be undone completely.
+  bool applied = true;
+  impl::atomic_files_t updated;
+  std::vector <std::string> updated_paths;
+  for (auto& file : impl::atomic_files)
+  {
+    if (file->is_tail_active)
+    {
+      if (! file->apply_tail ())
+      {
+        applied = false;
+        break;
+      }
+
+      updated.push_back (file);
+      updated_paths.push_back (file->real_file._data);
+    }
+  }
+
+  // The rollback records are only removed once the new tails are on the
+  // device.
+  if (applied && ! syncFiles (updated_paths))
+  {
+    applied = false;
+  }
+
+  if (! applied)
+  {
+    for (auto& file : updated)
+    {
+      file->restore_tail ();
+    }
+  }
+
+  for (auto& file : impl::atomic_files)
+  {
+    file->release_tail ();
+  }
+
+  if (! applied)
+  {
+    sigprocmask (SIG_SETMASK, &old_mask, nullptr);
+    throw std::string {"Unable to update database."};
+  }
+
+  // Step 4: Rename the temp files to the *real* file
   for (auto& file : impl::atomic_files)
   {
     file->finalize ();
   }
+
+  bool synced = syncDirectories (changed);
   sigprocmask (SIG_SETMASK, &old_mask, nullptr);
 
-  // Step 3: Cleanup any references
+  // Step 5: Cleanup any references
   impl::atomic_files_t new_atomic_files;
   for (auto& file : impl::atomic_files)
   {
@@ -473,6 +1234,12 @@ void AtomicFile::finalize_all ()
   }
 
   new_atomic_files.swap(impl::atomic_files);
+
+  // The changes are already in place, so the command did not fail.
+  if (! synced)
+  {
+    std::cerr << "Warning: Unable to sync the database directory. Changes may not survive a crash.\n";
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
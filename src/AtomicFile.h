@@ -26,6 +26,7 @@
 #ifndef INCLUDED_ATOMICFILE
 #define INCLUDED_ATOMICFILE
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -55,6 +56,8 @@ public:
   void read (std::vector <std::string>& lines);
   void append (const std::string& content);
   void write_raw (const std::string& content);
+  void replace_tail (size_t offset, const std::string& content);
+  bool copy_with_tail (size_t offset, const std::string& content, uint64_t size, int64_t mtime);
 
   static void append (const Path& path, const std::string& data);
 
@@ -64,6 +67,7 @@ public:
   static void read (const Path& path, std::string& content);
   static void read (const Path& path, std::vector <std::string>& lines);
 
+  static bool recover (const Path& path);
   static void finalize_all ();
   static void reset ();
 
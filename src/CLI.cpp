@@ -403,12 +403,22 @@ void CLI::identifyOverrides ()
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Scan all arguments and identify instances of '@<integer>'.
+// Scan all arguments and identify instances of '@<integer>', and of stable ids
+// '@#<id>'. The latter are only given an integer value by resolveStableId.
 void CLI::identifyIds ()
 {
   for (auto& a : _args)
   {
-    if (a._lextype == Lexer::Type::word)
+    auto raw = a.attribute ("raw");
+    if (raw.compare (0, 2, "@#") == 0)
+    {
+      if (parseStableId (raw.substr (2)) == 0)
+        throw format ("'{1}' is not a valid stable ID.", raw);
+
+      a.tag ("ID");
+      a.attribute ("uid", raw.substr (2));
+    }
+    else if (a._lextype == Lexer::Type::word)
     {
       Pig pig (a.attribute ("raw"));
       int digits;
@@ -556,13 +566,40 @@ std::set<int> CLI::getIds() const
 
   for (auto& arg : _args)
   {
-    if (arg.hasTag ("ID"))
+    if (arg.hasTag ("ID") && arg.attribute ("value") != "")
       ids.insert (strtol (arg.attribute ("value").c_str (), nullptr, 10));
   }
 
   return ids;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// The stable ids given as '@#<id>'.
+std::set <uint64_t> CLI::getStableIds () const
+{
+  std::set <uint64_t> uids;
+
+  for (auto& arg : _args)
+  {
+    if (arg.hasTag ("ID") && arg.attribute ("uid") != "")
+      uids.insert (parseStableId (arg.attribute ("uid")));
+  }
+
+  return uids;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Gives the arguments naming a stable id the id of the interval it belongs to,
+// so that getIds includes it.
+void CLI::resolveStableId (uint64_t uid, int id)
+{
+  for (auto& arg : _args)
+  {
+    if (arg.hasTag ("ID") && parseStableId (arg.attribute ("uid")) == uid)
+      arg.attribute ("value", id);
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 std::set <std::string> CLI::getTags () const
 {
@@ -30,6 +30,7 @@
 #include <Duration.h>
 #include <Interval.h>
 #include <Lexer.h>
+#include <cstdint>
 #include <map>
 #include <set>
 #include <string>
@@ -70,6 +71,8 @@ public:
   bool getComplementaryHint (const std::string&, bool) const;
   bool getHint(const std::string&, bool) const;
   std::set <int> getIds () const;
+  std::set <uint64_t> getStableIds () const;
+  void resolveStableId (uint64_t, int);
   std::set<std::string> getTags () const;
   std::string getAnnotation() const;
   Duration getDuration() const;
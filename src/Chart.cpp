@@ -26,7 +26,9 @@
 
 #include <Chart.h>
 #include <Composite.h>
+#include <DayBuckets.h>
 #include <Duration.h>
+#include <TagDictionary.h>
 #include <cassert>
 #include <format.h>
 #include <iomanip>
@@ -62,13 +64,25 @@ Chart::Chart (const ChartConfig& configuration) :
 
 std::string Chart::render (
   const Range& range,
-  const std::vector<Interval> &tracked,
+  const IntervalColumns& tracked,
   const std::vector<Range> &exclusions,
-  const std::map<Datetime, std::string> &holidays)
+  const HolidayCalendar &holidays)
 {
+  // Each interval is assigned to the days it overlaps once, up front, rather
+  // than every interval being tested against every day.
+  std::vector <Datetime> days;
+  std::vector <Range> day_ranges;
+  for (Datetime day = range.start; day < range.end; day++)
+  {
+    days.push_back (day);
+    day_ranges.push_back (getFullDay (day));
+  }
+
+  DayBuckets buckets (tracked, day_ranges);
+
   // Determine hours shown.
   auto hour_range = determine_hour_range
-                    ? determineHourRange (range, tracked)
+                    ? determineHourRange (day_ranges, tracked, buckets)
                     : std::make_pair (0, 23);
 
   int first_hour = hour_range.first;
@@ -97,27 +111,55 @@ std::string Chart::render (
   // Each day is rendered separately.
   time_t total_work = 0;
 
-  for (Datetime day = range.start; day < range.end; day++)
+  // Add an empty string with no color, to reserve width, so this function
+  // can simply concatenate to lines[i].str ().
+  const std::string blank (total_width, ' ');
+  std::vector<Composite> lines;
+  lines.reserve (num_lines);
+
+  // The exclusions are sorted, so those of each day follow those of the day
+  // before.
+  size_t first_exclusion = 0;
+
+  for (size_t d = 0; d < days.size (); ++d)
   {
-    // Render the exclusion blocks.
+    auto day = days[d];
+    const auto& day_range = day_ranges[d];
 
-    // Add an empty string with no color, to reserve width, so this function
-    // can simply concatenate to lines[i].str ().
-    std::vector<Composite> lines (num_lines);
+    lines.clear ();
     for (int i = 0; i < num_lines; ++i)
     {
-      lines[i].add (std::string (total_width, ' '), 0, Color ());
+      lines.emplace_back ();
+      lines.back ().add (blank, 0, Color ());
+    }
+
+    // Render the exclusion blocks.
+    while (first_exclusion < exclusions.size () &&
+           exclusions[first_exclusion].is_ended () &&
+           exclusions[first_exclusion].end <= day_range.start)
+    {
+      ++first_exclusion;
+    }
+
+    auto last_exclusion = first_exclusion;
+    while (last_exclusion < exclusions.size () &&
+           exclusions[last_exclusion].start < day_range.end)
+    {
+      ++last_exclusion;
     }
 
-    renderExclusionBlocks (lines, day, first_hour, last_hour, exclusions);
+    renderExclusionBlocks (lines, day, first_hour, last_hour,
+                           exclusions.begin () + first_exclusion,
+                           exclusions.begin () + last_exclusion);
 
     time_t work = 0;
     if (!show_intervals)
     {
-      for (auto &track : tracked)
+      // Only the intervals of the day are materialized for rendering.
+      for (auto i : buckets.bucket (d))
       {
         time_t interval_work = 0;
-        renderInterval (lines, day, track, first_hour, interval_work);
+        renderInterval (lines, day, tracked.interval (i), first_hour, interval_work);
         work += interval_work;
       }
     }
@@ -153,7 +195,7 @@ std::string Chart::render (
   }
 
   out << (with_totals ? renderSubTotal (total_work, std::string (padding_size, ' ')) : "")
-      << (with_holidays ? renderHolidays (holidays) : "")
+      << (with_holidays ? renderHolidays (range, holidays) : "")
       << (with_summary ? renderSummary (indent, range, exclusions, tracked) : "");
 
   return out.str ();
@@ -169,11 +211,13 @@ unsigned long Chart::getIndentSize ()
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Scan all tracked intervals, looking for the earliest and latest hour into
-// which an interval extends.
+// Scan the tracked intervals of each day, looking for the earliest and latest
+// hour into which an interval extends. Only the epochs of the intervals are
+// read, rather than each interval being copied and clipped.
 std::pair<int, int> Chart::determineHourRange (
-  const Range& range,
-  const std::vector<Interval> &tracked)
+  const std::vector <Range>& days,
+  const IntervalColumns& tracked,
+  const DayBuckets& buckets)
 {
   // If there is no data, show the whole day.
   if (tracked.empty ())
@@ -185,32 +229,37 @@ std::pair<int, int> Chart::determineHourRange (
   auto first_hour = 23;
   auto last_hour = 0;
 
-  for (Datetime day = range.start; day < range.end; day++)
+  for (size_t d = 0; d < days.size (); ++d)
   {
-    auto day_range = getFullDay (day);
+    const int64_t day_start = days[d].start.toEpoch ();
+    const int64_t day_end = days[d].end.toEpoch ();
 
-    for (auto& track : tracked)
+    for (auto i : buckets.bucket (d))
     {
-      Interval test {track};
+      auto start = tracked.start (i);
+      auto end = tracked.end (i);
 
-      if (test.is_open ())
+      // An open interval is closed at the reference time.
+      if (end == 0)
       {
-        test.end = reference_datetime;
+        end = reference_datetime.toEpoch ();
       }
 
-      if (day_range.overlaps (test))
+      if (end <= day_start || start >= day_end)
       {
-        Interval clipped = clip (test, day_range);
+        continue;
+      }
 
-        if (clipped.start.hour () < first_hour)
-        {
-          first_hour = clipped.start.hour ();
-        }
+      auto start_hour = Datetime (std::max (start, day_start)).hour ();
+      if (start_hour < first_hour)
+      {
+        first_hour = start_hour;
+      }
 
-        if (!clipped.is_open () && clipped.end.hour () > last_hour)
-        {
-          last_hour = clipped.end.hour ();
-        }
+      auto end_hour = Datetime (std::min (end, day_end)).hour ();
+      if (end_hour > last_hour)
+      {
+        last_hour = end_hour;
       }
     }
   }
@@ -301,19 +350,16 @@ std::string Chart::renderDay (Datetime &day, const Color &color)
 ////////////////////////////////////////////////////////////////////////////////
 Color Chart::getDayColor (
   const Datetime &day,
-  const std::map <Datetime, std::string> &holidays)
+  const HolidayCalendar &holidays)
 {
   if (day.sameDay (reference_datetime))
   {
     return color_today;
   }
 
-  for (auto &entry : holidays)
+  if (holidays.contains (day))
   {
-    if (day.sameDay (entry.first))
-    {
-      return color_holiday;
-    }
+    return color_holiday;
   }
 
   return Color {};
@@ -365,12 +411,16 @@ std::string Chart::renderSubTotal (
   return out.str ();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Renders the exclusions in [first, last), which are those that overlap the
+// day.
 void Chart::renderExclusionBlocks (
   std::vector<Composite> &lines,
   const Datetime &day,
   int first_hour,
   int last_hour,
-  const std::vector <Range>& exclusions)
+  std::vector <Range>::const_iterator first,
+  std::vector <Range>::const_iterator last)
 {
   // Render the exclusion blocks.
   for (int hour = first_hour; hour <= last_hour; hour++)
@@ -386,12 +436,12 @@ void Chart::renderExclusionBlocks (
       lines[0].add (label, offset, color_label);
     }
 
-    for (auto& exclusion : exclusions)
+    for (auto exclusion = first; exclusion != last; ++exclusion)
     {
-      if (exclusion.overlaps (hour_range))
+      if (exclusion->overlaps (hour_range))
       {
         // Determine which of the character blocks included.
-        auto sub_hour = exclusion.intersect (hour_range);
+        auto sub_hour = exclusion->intersect (hour_range);
         auto start_block = quantizeToNMinutes (sub_hour.start.minute (), minutes_per_char) / minutes_per_char;
         auto end_block = quantizeToNMinutes (sub_hour.end.minute () == 0 ? 60 : sub_hour.end.minute (), minutes_per_char) / minutes_per_char;
 
@@ -466,8 +516,12 @@ void Chart::renderInterval (
 
   if (end_offset > start_offset)
   {
+    // Tags are blended and shown in the order of their names.
+    auto tags = track.tagIds ();
+    TagDictionary::sortByName (tags);
+
     // Determine color of interval.
-    Color colorTrack = chartIntervalColor (track.tags (), tag_colors);
+    Color colorTrack = chartIntervalColor (tags, tag_colors);
 
     // Properly format the tags within the space.
     std::string label;
@@ -476,14 +530,14 @@ void Chart::renderInterval (
       label = format ("@{1}", track.id);
     }
 
-    for (auto &tag : track.tags ())
+    for (auto id : tags)
     {
       if (!label.empty ())
       {
         label += ' ';
       }
 
-      label += tag;
+      label += TagDictionary::name (id);
     }
 
     auto width = end_offset - start_offset;
@@ -531,15 +585,20 @@ void Chart::renderInterval (
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-std::string Chart::renderHolidays (const std::map<Datetime, std::string> &holidays)
+std::string Chart::renderHolidays (
+  const Range& range,
+  const HolidayCalendar &holidays)
 {
   std::stringstream out;
 
-  for (auto &entry : holidays)
+  auto slice = holidays.slice (range);
+  for (auto entry = slice.first; entry != slice.second; ++entry)
   {
-    out << entry.first.toString ("Y-M-D")
-        << " "
-        << entry.second
+    out << HolidayCalendar::date (entry->day)
+        << "  ["
+        << entry->locale
+        << "] "
+        << entry->name
         << '\n';
   }
 
@@ -551,7 +610,7 @@ std::string Chart::renderSummary (
   const std::string &indent,
   const Range& range,
   const std::vector<Range> &exclusions,
-  const std::vector<Interval> &tracked)
+  const IntervalColumns& tracked)
 {
   std::stringstream out;
   time_t total_unavailable = 0;
@@ -568,10 +627,11 @@ std::string Chart::renderSummary (
 
   if (!show_intervals)
   {
-    for (auto &interval : tracked)
+    for (size_t i = 0; i < tracked.size (); ++i)
     {
-      if (range.overlaps (interval))
+      if (tracked.overlaps (i, range))
       {
+        auto interval = tracked.interval (i);
         Interval clipped = clip (interval, range);
         if (interval.is_open ())
         {
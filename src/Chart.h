@@ -29,7 +29,10 @@
 
 #include <ChartConfig.h>
 #include <Composite.h>
+#include <DayBuckets.h>
+#include <HolidayCalendar.h>
 #include <Interval.h>
+#include <IntervalColumns.h>
 #include <map>
 
 class Chart
@@ -37,27 +40,27 @@ class Chart
 public:
   explicit Chart (const ChartConfig& configuration);
 
-  std::string render (const Range&, const std::vector <Interval>&, const std::vector <Range>&, const std::map <Datetime, std::string>&);
+  std::string render (const Range&, const IntervalColumns&, const std::vector <Range>&, const HolidayCalendar&);
 
 private:
   std::string renderAxis (int, int);
   std::string renderDay (Datetime&, const Color&);
-  std::string renderHolidays (const std::map <Datetime, std::string>&);
+  std::string renderHolidays (const Range&, const HolidayCalendar&);
   std::string renderMonth (const Datetime&, const Datetime&);
   std::string renderSubTotal (time_t, const std::string&);
-  std::string renderSummary (const std::string&, const Range&, const std::vector <Range>&, const std::vector <Interval>&);
+  std::string renderSummary (const std::string&, const Range&, const std::vector <Range>&, const IntervalColumns&);
   std::string renderTotal (time_t);
   std::string renderWeek (const Datetime&, const Datetime&);
   std::string renderWeekday (Datetime&, const Color&);
 
-  void renderExclusionBlocks (std::vector <Composite>&, const Datetime&, int, int, const std::vector <Range>&);
+  void renderExclusionBlocks (std::vector <Composite>&, const Datetime&, int, int, std::vector <Range>::const_iterator, std::vector <Range>::const_iterator);
   void renderInterval (std::vector<Composite>&, const Datetime&, const Interval&, int, time_t&);
 
   unsigned long getIndentSize ();
 
-  std::pair <int, int> determineHourRange (const Range&, const std::vector <Interval>&);
+  std::pair <int, int> determineHourRange (const std::vector <Range>&, const IntervalColumns&, const DayBuckets&);
 
-  Color getDayColor (const Datetime&, const std::map <Datetime, std::string>&);
+  Color getDayColor (const Datetime&, const HolidayCalendar&);
   Color getHourColor (int) const;
 
   const Datetime reference_datetime;
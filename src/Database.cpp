@@ -28,12 +28,41 @@
 #include <Database.h>
 #include <IntervalFactory.h>
 #include <JSON.h>
+#include <TagCountCache.h>
+#include <TagDictionary.h>
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
+#include <exception>
 #include <format.h>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <sstream>
+#include <system_error>
+#include <thread>
 #include <timew.h>
 
+// The log is only folded into tags.data once it has more entries than this,
+// or than there are tags.
+static const size_t MINIMUM_TAG_LOG_ENTRIES = 64;
+
+////////////////////////////////////////////////////////////////////////////////
+// FNV-1a, to tell which tags.data a tags.log was written for.
+static std::string checksum (const std::string& content)
+{
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (unsigned char c : content)
+  {
+    hash = (hash ^ c) * 0x100000001b3ULL;
+  }
+
+  std::stringstream out;
+  out << std::hex << std::setw (16) << std::setfill ('0') << hash;
+  return out.str ();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 Database::iterator::iterator (files_iterator fbegin, files_iterator fend) :
           files_it(fbegin),
@@ -41,20 +70,25 @@ Database::iterator::iterator (files_iterator fbegin, files_iterator fend) :
 {
     if (files_end != files_it)
     {
-      auto &lines = files_it->allLines ();
-      lines_it = lines.rbegin ();
-      lines_end = lines.rend ();
-      while ((lines_it == lines_end) && (files_it != files_end))
-      {
-        ++files_it;
-        if (files_it != files_end)
-        {
-          auto& lines = files_it->allLines ();
-          lines_it = lines.rbegin ();
-          lines_end = lines.rend ();
-        }
-      }
+      lines_left = files_it->second.count ();
+      skipEmptyFiles ();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A file may be empty, which is why we need to advance until we are pointing
+// at a valid line. Only the number of lines is needed, which the Datafile can
+// usually take from its index without reading the file.
+void Database::iterator::skipEmptyFiles ()
+{
+  while ((lines_left == 0) && (files_it != files_end))
+  {
+    ++files_it;
+    if (files_it != files_end)
+    {
+      lines_left = files_it->second.count ();
     }
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -62,23 +96,13 @@ Database::iterator& Database::iterator::operator++()
 {
   if (files_it != files_end)
   {
-    if (lines_it != lines_end)
+    if (lines_left != 0)
     {
-      ++lines_it;
+      --lines_left;
 
       // If we are at the end of the current file, we will need to advance to
-      // the next file here. A file may be empty, which is why we need to wait
-      // until we are pointing at a valid line.
-      while ((lines_it == lines_end) && (files_it != files_end))
-      {
-        ++files_it;
-        if (files_it != files_end)
-        {
-          auto& lines = files_it->allLines ();
-          lines_it = lines.rbegin ();
-          lines_end = lines.rend ();
-        }
-      }
+      // the next file here.
+      skipEmptyFiles ();
     }
   }
   return *this;
@@ -91,8 +115,7 @@ bool Database::iterator::operator==(const iterator & other) const
           files_it == files_end :
          ((files_it == other.files_it) &&
           (files_end == other.files_end) &&
-          (lines_it == other.lines_it) &&
-          (lines_end == other.lines_end));
+          (lines_left == other.lines_left));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -102,17 +125,66 @@ bool Database::iterator::operator!=(const iterator & other) const
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-const std::string& Database::iterator::operator*() const
+const std::string_view& Database::iterator::operator*() const
 {
-  assert(lines_it != lines_end);
-  return *lines_it;
+  assert(lines_left != 0);
+  return files_it->second.allLines ()[lines_left - 1];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const std::string_view* Database::iterator::operator->() const
+{
+  return &operator*();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-const std::string* Database::iterator::operator->() const
+// Decodes the current line, preferably from the index of the Datafile.
+Interval Database::iterator::interval () const
 {
-  assert(lines_it != lines_end);
-  return &(*lines_it);
+  assert(lines_left != 0);
+  return files_it->second.interval (lines_left - 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Moves past all files for months starting at or after the given date, which
+// cannot hold an interval that starts before it. Returns the number of lines
+// skipped, so that callers can keep interval ids correct. Only the line count
+// of a skipped file is needed, which comes from its index, not the data.
+size_t Database::iterator::skipFrom (const Datetime& date)
+{
+  size_t skipped = 0;
+  while (files_it != files_end &&
+         files_it->second.range ().start >= date)
+  {
+    skipped += lines_left;
+    lines_left = 0;
+    skipEmptyFiles ();
+  }
+
+  return skipped;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Moves past up to count lines. Whole files are skipped by their line count,
+// which comes from the index of each month, so reaching the line with a given
+// id reads only the file that holds it. Returns the number of lines skipped.
+size_t Database::iterator::skip (size_t count)
+{
+  size_t skipped = 0;
+  while (files_it != files_end && count - skipped >= lines_left)
+  {
+    skipped += lines_left;
+    lines_left = 0;
+    skipEmptyFiles ();
+  }
+
+  if (files_it != files_end)
+  {
+    lines_left -= count - skipped;
+    skipped = count;
+  }
+
+  return skipped;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -123,14 +195,14 @@ Database::reverse_iterator::reverse_iterator (files_iterator fbegin,
 {
     if (files_end != files_it)
     {
-      lines_it = files_it->allLines ().begin ();
-      lines_end = files_it->allLines ().end ();
+      lines_it = files_it->second.allLines ().begin ();
+      lines_end = files_it->second.allLines ().end ();
       while ((lines_it == lines_end) && (files_it != files_end))
       {
         ++files_it;
         if (files_it != files_end)
         {
-          auto& lines = files_it->allLines ();
+          auto& lines = files_it->second.allLines ();
           lines_it = lines.begin ();
           lines_end = lines.end ();
         }
@@ -155,8 +227,8 @@ Database::reverse_iterator& Database::reverse_iterator::operator++()
         ++files_it;
         if (files_it != files_end)
         {
-          lines_it = files_it->allLines ().begin ();
-          lines_end = files_it->allLines ().end ();
+          lines_it = files_it->second.allLines ().begin ();
+          lines_end = files_it->second.allLines ().end ();
         }
       }
     }
@@ -184,14 +256,14 @@ Database::reverse_iterator::operator!=(const reverse_iterator & other) const
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-const std::string& Database::reverse_iterator::operator*() const
+const std::string_view& Database::reverse_iterator::operator*() const
 {
   assert (lines_it != lines_end);
   return *lines_it;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-const std::string* Database::reverse_iterator::operator->() const
+const std::string_view* Database::reverse_iterator::operator->() const
 {
   return &operator*();
 }
@@ -199,10 +271,7 @@ const std::string* Database::reverse_iterator::operator->() const
 ////////////////////////////////////////////////////////////////////////////////
 Database::iterator Database::begin ()
 {
-  if (_files.empty ())
-  {
-    initializeDatafiles ();
-  }
+  initializeDatafiles ();
 
   return iterator (_files.rbegin (), _files.rend ());
 }
@@ -210,10 +279,7 @@ Database::iterator Database::begin ()
 ////////////////////////////////////////////////////////////////////////////////
 Database::iterator Database::end ()
 {
-  if (_files.empty ())
-  {
-    initializeDatafiles ();
-  }
+  initializeDatafiles ();
 
   return iterator (_files.rend (), _files.rend ());
 }
@@ -222,10 +288,7 @@ Database::iterator Database::end ()
 ////////////////////////////////////////////////////////////////////////////////
 Database::reverse_iterator Database::rbegin ()
 {
-  if (_files.empty ())
-  {
-    initializeDatafiles ();
-  }
+  initializeDatafiles ();
 
   return reverse_iterator(_files.begin (), _files.end ());
 }
@@ -233,33 +296,82 @@ Database::reverse_iterator Database::rbegin ()
 ////////////////////////////////////////////////////////////////////////////////
 Database::reverse_iterator Database::rend ()
 {
-  if (_files.empty ())
-  {
-    initializeDatafiles ();
-  }
+  initializeDatafiles ();
 
   return reverse_iterator (_files.end (), _files.end ());
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-void Database::initialize (const std::string& location, Journal& journal)
+void Database::initialize (const std::string& location, Journal& journal, bool stableIds)
 {
   _location = location;
   _journal = &journal;
+  _assignStableIds = stableIds;
+  _stableIds.initialize (location);
   initializeTagDatabase ();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Keeps the state file of the database up to date, for the configuration files
+// given. The state file is only used if the configuration is usable for it.
+void Database::initializeState (const std::vector <std::string>& configs, bool usable)
+{
+  _state.initialize (_location, configs, usable);
+  _stateEnabled = true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void Database::commit ()
 {
   for (auto& file : _files)
   {
-    file.commit ();
+    file.second.commit ();
   }
 
   if (_tagInfoDatabase.is_modified ())
   {
-    AtomicFile::write (_location + "/tags.data", _tagInfoDatabase.toJson ());
+    auto changes = _tagInfoDatabase.toLog ();
+    auto entries = static_cast <size_t> (std::count (changes.begin (), changes.end (), '\n'));
+
+    if (_tagLog == nullptr)
+    {
+      _tagLog = std::make_unique <LogFile> (Path (_location + "/tags.log"));
+    }
+
+    if (_tagLogEntries + entries > std::max (_tagInfoDatabase.size (), MINIMUM_TAG_LOG_ENTRIES))
+    {
+      // The changes still go to the log, so that the log stays complete for
+      // the old tags.data, should only the log be updated.
+      if (_tagLogValid)
+      {
+        _tagLog->append (changes);
+      }
+
+      writeTagCheckpoint ();
+    }
+    else
+    {
+      // A log that is started over is written in one piece.
+      if (! _tagLogValid)
+      {
+        _tagLog->truncate (0);
+        changes = "checkpoint " + _tagCheckpoint + '\n' + changes;
+        _tagLogValid = true;
+        _tagLogEntries = 0;
+      }
+
+      _tagLog->append (changes);
+      _tagLogEntries += entries;
+    }
+
+    _tagInfoDatabase.clear_modified ();
+  }
+
+  _stableIds.commit ();
+
+  if (_stateEnabled && (_modified || ! _state.current ()))
+  {
+    writeState ();
   }
 }
 
@@ -269,7 +381,7 @@ std::vector <std::string> Database::files () const
   std::vector <std::string> all;
   for (auto& file : _files)
   {
-    all.push_back (file.name ());
+    all.push_back (file.second.name ());
   }
 
   return all;
@@ -282,11 +394,15 @@ std::set <std::string> Database::tags () const
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Return most recent line from database 
+// Return most recent line from database. Only the end of the newest data file
+// that has any intervals is read.
 std::string Database::getLatestEntry ()
 {
-  for (auto& line : *this)
+  initializeDatafiles ();
+
+  for (auto it = _files.rbegin (); it != _files.rend (); ++it)
   {
+    auto line = it->second.lastLine ();
     if (! line.empty ())
     {
       return line;
@@ -301,36 +417,33 @@ void Database::addInterval (const Interval& interval, bool verbose)
 {
   assert ( (interval.end == 0) || (interval.start <= interval.end));
 
-  auto tags = interval.tags ();
-  for (auto& tag : tags)
-  {
-    if (_tagInfoDatabase.incrementTag (tag) == -1 && verbose)
-    {
-      std::cout << "Note: '" << quoteIfNeeded (tag) << "' is a new tag." << std::endl;
-    }
-  }
+  Interval stored (interval);
+  assignStableId (stored);
 
-  // Get the index into _files for the appropriate Datafile, which may be
-  // created on demand.
-  auto df = getDatafile (interval.start.year (), interval.start.month ());
-  _files[df].addInterval (interval);
-  _journal->recordIntervalAction ("", interval.json ());
-}
+  countTags (stored, verbose);
 
-void Database::deleteInterval (const Interval& interval)
-{
-  auto tags = interval.tags ();
+  // Get the appropriate Datafile, which may be created on demand.
+  auto& df = getDatafile (stored.start.year (), stored.start.month ());
+  df.addInterval (stored);
+  _modified = true;
+  _journal->recordIntervalAction ("", stored.json ());
 
-  for (auto& tag : tags)
+  if (stored.uid)
   {
-    _tagInfoDatabase.decrementTag (tag);
+    _stableIds.set (stored.uid, stored.start.year (), stored.start.month ());
   }
+}
 
-  // Get the index into _files for the appropriate Datafile, which may be
-  // created on demand.
-  auto df = getDatafile (interval.start.year (), interval.start.month ());
+////////////////////////////////////////////////////////////////////////////////
+void Database::deleteInterval (const Interval& interval)
+{
+  releaseStableId (interval);
+  uncountTags (interval);
 
-  _files[df].deleteInterval (interval);
+  // Get the appropriate Datafile, which may be created on demand.
+  auto& df = getDatafile (interval.start.year (), interval.start.month ());
+  df.deleteInterval (interval);
+  _modified = true;
   _journal->recordIntervalAction (interval.json (), "");
 }
 
@@ -352,6 +465,125 @@ void Database::modifyInterval (const Interval& from, const Interval& to, bool ve
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Applies all changes of the batch, which is empty afterwards. Each data file
+// is looked up once, and its lines are scanned once for all deletions.
+//
+// The stable ids of all deleted intervals are released first, so that an
+// interval moved to another month keeps its id.
+void Database::apply (WriteBatch& batch, bool verbose)
+{
+  const bool record = _journal->enabled ();
+  std::string before;
+  std::string after;
+
+  for (auto& month : batch._changes)
+  {
+    for (auto& change : month.second.deleted)
+    {
+      releaseStableId (change.second);
+    }
+  }
+
+  for (auto& month : batch._changes)
+  {
+    std::vector <std::string> deleted;
+    deleted.reserve (month.second.deleted.size ());
+    for (auto& change : month.second.deleted)
+    {
+      uncountTags (change.second);
+      deleted.push_back (change.first);
+
+      if (record)
+      {
+        before += (before.empty () ? "" : ",") + change.second.json ();
+      }
+    }
+
+    std::vector <Interval> added;
+    added.reserve (month.second.added.size ());
+    for (auto& change : month.second.added)
+    {
+      assignStableId (change.second);
+      if (change.second.uid)
+      {
+        _stableIds.set (change.second.uid, month.first.first, month.first.second);
+      }
+
+      countTags (change.second, verbose);
+      added.push_back (change.second);
+
+      if (record)
+      {
+        after += (after.empty () ? "" : ",") + change.second.json ();
+      }
+    }
+
+    auto& df = getDatafile (month.first.first, month.first.second);
+    df.update (deleted, added);
+    _modified = true;
+  }
+
+  // Even a batch whose changes cancelled out is recorded, so that it can be
+  // undone like any other command.
+  if (! batch._changes.empty ())
+  {
+    _journal->recordIntervalsAction ('[' + before + ']', '[' + after + ']');
+  }
+
+  batch._changes.clear ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Database::WriteBatch::addInterval (const Interval& interval)
+{
+  assert ( (interval.end == 0) || (interval.start <= interval.end));
+
+  auto serialization = interval.serialize ();
+  auto& changes = _changes[std::make_pair (interval.start.year (), interval.start.month ())];
+
+  auto found = changes.deleted.find (serialization);
+  if (found != changes.deleted.end ())
+  {
+    changes.deleted.erase (found);
+  }
+  else
+  {
+    changes.added.emplace (std::move (serialization), interval);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Database::WriteBatch::deleteInterval (const Interval& interval)
+{
+  auto serialization = interval.serialize ();
+  auto& changes = _changes[std::make_pair (interval.start.year (), interval.start.month ())];
+
+  auto found = changes.added.find (serialization);
+  if (found != changes.added.end ())
+  {
+    changes.added.erase (found);
+  }
+  else
+  {
+    changes.deleted.emplace (std::move (serialization), interval);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Database::WriteBatch::modifyInterval (const Interval& from, const Interval& to)
+{
+  if (!from.empty ())
+  {
+    deleteInterval (from);
+  }
+
+  if (!to.empty ())
+  {
+    addInterval (to);
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 std::string Database::dump () const
 {
@@ -359,15 +591,26 @@ std::string Database::dump () const
   out << "Database\n";
   for (auto& df : _files)
   {
-    out << df.dump ();
+    out << df.second.dump ();
   }
 
   return out.str ();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-unsigned int Database::getDatafile (int year, int month)
+// Looks up the Datafile for a month in the catalog. Files for months that do
+// not exist yet are created on demand, and take their place in the order.
+Datafile& Database::getDatafile (int year, int month)
 {
+  initializeDatafiles ();
+
+  auto key = std::make_pair (year, month);
+  auto found = _files.find (key);
+  if (found != _files.end ())
+  {
+    return found->second;
+  }
+
   std::stringstream file;
   file << _location
        << '/'
@@ -375,81 +618,142 @@ unsigned int Database::getDatafile (int year, int month)
        << '-'
        << std::setw (2) << std::setfill ('0') << month
        << ".data";
-  auto name = file.str ();
-  auto basename = Path (name).name ();
 
-  // If the datafile is already initialized, return.
-  for (unsigned int i = 0; i < _files.size (); ++i)
+  Datafile df;
+  df.initialize (file.str ());
+  return _files.emplace (key, std::move (df)).first->second;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Returns the position of the interval with the given stable id, counting from
+// 1 for the latest interval, or 0 if there is none. The index names the month
+// to look in. Should the interval not be there, all months are searched.
+size_t Database::positionOf (uint64_t uid)
+{
+  int year;
+  int month;
+  if (_stableIds.find (uid, year, month))
   {
-    if (_files[i].name () == basename)
+    auto position = positionIn (year, month, uid);
+    if (position)
     {
-      return i;
+      return position;
     }
   }
 
-  // Create the Datafile.
-  Datafile df;
-  df.initialize (name);
+  size_t position = 0;
+  for (auto& line : *this)
+  {
+    ++position;
+    if (IntervalFactory::stableId (line) == uid)
+    {
+      return position;
+    }
+  }
 
-  // Insert Datafile into _files. The position is not important.
-  _files.push_back (df);
-  return _files.size () - 1;
+  return 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// The input Daterange has a start and end, for example:
-//
-//   2016-02-20 to 2016-04-15
-//
-// Given the monthly storage scheme, split the Daterange into a vector of
-// segmented Dateranges:
-//
-//   2016-02-01 to 2016-03-01
-//   2016-03-01 to 2016-04-01
-//   2016-04-01 to 2016-05-01
-//
-std::vector <Range> Database::segmentRange (const Range& range)
+// Only the lines of the given month are read. The newer months count by their
+// number of lines.
+size_t Database::positionIn (int year, int month, uint64_t uid)
 {
-  std::vector <Range> segments;
+  initializeDatafiles ();
 
-  auto start_y = range.start.year ();
-  auto start_m = range.start.month ();
+  auto found = _files.find (std::make_pair (year, month));
+  if (found == _files.end ())
+  {
+    return 0;
+  }
 
-  auto end = range.end;
-  if (end.toEpoch () == 0)
+  auto& lines = found->second.allLines ();
+  for (size_t i = lines.size (); i > 0; --i)
   {
-    end = Datetime ();
+    if (IntervalFactory::stableId (lines[i - 1]) == uid)
+    {
+      size_t position = lines.size () - i + 1;
+      for (auto newer = std::next (found); newer != _files.end (); ++newer)
+      {
+        position += newer->second.count ();
+      }
+
+      return position;
+    }
   }
 
-  auto end_y = end.year ();
-  auto end_m = end.month ();
+  return 0;
+}
 
-  while (start_y < end_y ||
-         (start_y == end_y && start_m <= end_m))
+////////////////////////////////////////////////////////////////////////////////
+// An interval keeps its stable id if it replaces the interval that had it, or
+// if no interval has it, as when a deletion is undone. Any other interval with
+// an id is a copy, and gets an id of its own, as do new intervals, unless
+// stable ids are turned off.
+void Database::assignStableId (Interval& interval)
+{
+  if (interval.uid)
   {
-    // Capture date before incrementing month.
-    Datetime segmentStart (start_y, start_m, 1);
+    if (_releasedIds.erase (interval.uid))
+    {
+      return;
+    }
 
-    // Next month.
-    start_m += 1;
-    if (start_m > 12)
+    int year;
+    int month;
+    if (! _stableIds.find (interval.uid, year, month))
     {
-      start_y += 1;
-      start_m = 1;
+      return;
     }
+  }
+
+  interval.uid = _assignStableIds ? StableIdIndex::generate () : 0;
+}
 
-    // Capture date after incrementing month.
-    Datetime segmentEnd (start_y, start_m, 1);
-    auto segment = Range (segmentStart, segmentEnd);
-    if (range.intersects (segment))
+////////////////////////////////////////////////////////////////////////////////
+void Database::releaseStableId (const Interval& interval)
+{
+  if (interval.uid)
+  {
+    _stableIds.erase (interval.uid);
+    _releasedIds.insert (interval.uid);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Counts the tags of an interval in the tag database. New tags are noted in
+// the order of their names.
+void Database::countTags (const Interval& interval, bool verbose)
+{
+  std::vector <unsigned int> added;
+  for (auto id : interval.tagIds ())
+  {
+    if (_tagInfoDatabase.incrementTag (TagDictionary::name (id)) == -1)
     {
-      segments.push_back (segment);
+      added.push_back (id);
     }
   }
 
-  return segments;
+  if (verbose && ! added.empty ())
+  {
+    TagDictionary::sortByName (added);
+    for (auto id : added)
+    {
+      std::cout << "Note: '" << quoteIfNeeded (TagDictionary::name (id)) << "' is a new tag." << std::endl;
+    }
+  }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void Database::uncountTags (const Interval& interval)
+{
+  for (auto id : interval.tagIds ())
+  {
+    _tagInfoDatabase.decrementTag (TagDictionary::name (id));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
 bool Database::empty ()
 {
   return Database::begin () == Database::end ();
@@ -459,6 +763,9 @@ bool Database::empty ()
 void Database::initializeTagDatabase ()
 {
   _tagInfoDatabase = TagInfoDatabase ();
+  _tagLogValid = false;
+  _tagLogEntries = 0;
+
   Path tags_path (_location + "/tags.data");
   std::string content;
   const bool exists = tags_path.exists ();
@@ -467,28 +774,36 @@ void Database::initializeTagDatabase ()
   {
     try
     {
-      std::unique_ptr <json::object> json (dynamic_cast <json::object *>(json::parse (content)));
-
-      if (content.empty () || (json == nullptr))
+      // Anything but the layout written by TagInfoDatabase::toJson goes
+      // through the JSON parser.
+      if (! _tagInfoDatabase.fromJson (content))
       {
-          throw std::string ("Contents invalid.");
-      }
-
-      for (auto &pair : json->_data)
-      {
-        auto key = json::decode (pair.first);
-        auto *value = (json::object *) pair.second;
-        auto iter = value->_data.find ("count");
+        std::unique_ptr <json::object> json (dynamic_cast <json::object *>(json::parse (content)));
 
-        if (iter == value->_data.end ())
+        if (content.empty () || (json == nullptr))
         {
-          throw format ("Failed to find \"count\" member for tag \"{1}\" in tags database.", key);
+            throw std::string ("Contents invalid.");
         }
 
-        auto number = dynamic_cast<json::number *> (iter->second);
-        _tagInfoDatabase.add (key, TagInfo{(unsigned int) number->_dvalue});
+        for (auto &pair : json->_data)
+        {
+          auto key = json::decode (pair.first);
+          auto *value = (json::object *) pair.second;
+          auto iter = value->_data.find ("count");
+
+          if (iter == value->_data.end ())
+          {
+            throw format ("Failed to find \"count\" member for tag \"{1}\" in tags database.", key);
+          }
+
+          auto number = dynamic_cast<json::number *> (iter->second);
+          _tagInfoDatabase.add (key, TagInfo{(unsigned int) number->_dvalue});
+        }
       }
 
+      _tagCheckpoint = checksum (content);
+      loadTagLog ();
+
       // Since we just loaded the database from the file, there we can clear the
       // modified state so that we will not write it back out unless there is a
       // new change.
@@ -504,46 +819,259 @@ void Database::initializeTagDatabase ()
 
   // We always want the tag database file to exist.
   _tagInfoDatabase = TagInfoDatabase();
-  AtomicFile::write (_location + "/tags.data", _tagInfoDatabase.toJson ());
 
   auto it = Database::begin ();
   auto end = Database::end ();
-  
-  if (it == end)
+
+  if (it != end)
+  {
+    if (!exists)
+    {
+      std::cout << "Tags database does not exist. ";
+    }
+
+    std::cout << "Recreating from interval data..." << std::endl;
+    rebuildTagDatabase ();
+  }
+
+  writeTagCheckpoint ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Counts the tags of all months, and merges the counts into the tag database.
+// Months whose file is unchanged since the last rebuild are taken from
+// tags.months, and the others are counted in parallel.
+void Database::rebuildTagDatabase ()
+{
+  struct Month
+  {
+    Datafile*                              file   {nullptr};
+    uint64_t                               size   {0};
+    int64_t                                mtime  {0};
+    const TagCountCache::counts*           cached {nullptr};
+    std::map <unsigned int, unsigned int>  ids    {};
+    std::exception_ptr                     error  {};
+  };
+
+  initializeDatafiles ();
+
+  Path cache_path (_location + "/tags.months");
+  TagCountCache cache;
+  cache.load (cache_path);
+
+  std::vector <Month> months;
+  std::vector <Month*> stale;
+  months.reserve (_files.size ());
+
+  for (auto& file : _files)
+  {
+    Month month;
+    month.file = &file.second;
+    if (month.file->signature (month.size, month.mtime))
+    {
+      month.cached = cache.find (month.file->name (), month.size, month.mtime);
+    }
+
+    months.push_back (month);
+  }
+
+  for (auto& month : months)
+  {
+    if (month.cached == nullptr)
+    {
+      stale.push_back (&month);
+    }
+  }
+
+  debug (format ("Counting tags of {1} of {2} months", stale.size (), months.size ()));
+
+  std::atomic <size_t> next {0};
+  auto worker = [&stale, &next] ()
+  {
+    for (auto i = next++; i < stale.size (); i = next++)
+    {
+      try
+      {
+        stale[i]->file->countTags (stale[i]->ids);
+      }
+      catch (...)
+      {
+        stale[i]->error = std::current_exception ();
+      }
+    }
+  };
+
+  std::vector <std::thread> threads;
+  auto concurrency = std::max (1u, std::thread::hardware_concurrency ());
+  while (threads.size () + 1 < std::min <size_t> (concurrency, stale.size ()))
+  {
+    try
+    {
+      threads.emplace_back (worker);
+    }
+    catch (const std::system_error&)
+    {
+      break;
+    }
+  }
+
+  worker ();
+
+  for (auto& thread : threads)
+  {
+    thread.join ();
+  }
+
+  // Errors are reported for the earliest month, as a serial rebuild would.
+  TagCountCache updated;
+  std::map <std::string, unsigned int> totals;
+
+  for (auto& month : months)
+  {
+    if (month.error)
+    {
+      std::rethrow_exception (month.error);
+    }
+
+    TagCountCache::counts tags;
+    if (month.cached != nullptr)
+    {
+      tags = *month.cached;
+    }
+    else
+    {
+      for (auto& id : month.ids)
+      {
+        tags[TagDictionary::name (id.first)] = id.second;
+      }
+    }
+
+    for (auto& tag : tags)
+    {
+      totals[tag.first] += tag.second;
+    }
+
+    updated.set (month.file->name (), month.size, month.mtime, tags);
+  }
+
+  for (auto& total : totals)
+  {
+    _tagInfoDatabase.add (total.first, TagInfo {total.second});
+  }
+
+  updated.save (cache_path);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A log that was not written for the current tags.data is left over from an
+// interrupted update, and tags.data already holds all of its changes.
+void Database::loadTagLog ()
+{
+  Path log_path (_location + "/tags.log");
+  std::string content;
+
+  AtomicFile::recover (log_path);
+  if (! log_path.exists () || ! File::read (log_path, content))
   {
     return;
   }
 
-  if (!exists)
+  auto eol = content.find ('\n');
+  if (eol == std::string::npos ||
+      content.compare (0, eol, "checkpoint " + _tagCheckpoint) != 0)
   {
-    std::cout << "Tags database does not exist. ";
+    debug ("tags.log does not extend tags.data, and is ignored");
+    return;
   }
-  
-  std::cout << "Recreating from interval data..." << std::endl;
 
-  for (; it != end; ++it)
+  _tagLogEntries = _tagInfoDatabase.fromLog (content.substr (eol + 1));
+  _tagLogValid = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Writes all tags to tags.data. The log no longer matches it, and is started
+// over with the next change.
+void Database::writeTagCheckpoint ()
+{
+  auto json = _tagInfoDatabase.toJson ();
+  AtomicFile::write (_location + "/tags.data", json);
+
+  _tagCheckpoint = checksum (json);
+  _tagLogValid = false;
+  _tagLogEntries = 0;
+  _tagInfoDatabase.clear_modified ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The tags of the state file are those of its intervals, most recent first.
+void Database::writeState ()
+{
+  std::vector <std::string> latest;
+  std::vector <std::string> tags;
+  std::vector <bool> seen;
+
+  for (auto& line : *this)
   {
-    Interval interval = IntervalFactory::fromSerialization (*it);
-    for (auto& tag : interval.tags ())
+    if (latest.size () == StateFile::intervals)
     {
-      _tagInfoDatabase.incrementTag (tag);
+      break;
+    }
+
+    if (line.empty ())
+    {
+      continue;
+    }
+
+    latest.emplace_back (line);
+    for (auto id : IntervalFactory::fromSerialization (line).tagIds ())
+    {
+      if (id >= seen.size ())
+      {
+        seen.resize (TagDictionary::size (), false);
+      }
+
+      if (! seen[id])
+      {
+        seen[id] = true;
+        tags.push_back (TagDictionary::name (id));
+      }
     }
   }
+
+  _state.write (latest, tags);
+  _modified = false;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 void Database::initializeDatafiles ()
 {
-  // Because the data files have names YYYY-MM.data, sorting them by name also
-  // sorts by the intervals within.
+  if (_files_initialized)
+  {
+    return;
+  }
+
+  // Only the directory is listed here. The files themselves are not opened
+  // until an iterator reaches them.
+  _files_initialized = true;
+
   Directory d (_location);
   auto files = d.list ();
-  std::sort (files.begin (), files.end ());
+
+  // An interrupted update of a data file leaves a rollback record behind.
+  for (auto& file : files)
+  {
+    if (file.length () > 9 &&
+        file.compare (file.length () - 9, 9, ".rollback") == 0)
+    {
+      AtomicFile::recover (file.substr (0, file.length () - 9));
+    }
+  }
 
   for (auto& file : files)
   {
     // If it looks like a data file: *-??.data
-    if (file[file.length () - 8] == '-' &&
+    if (file.length () >= 12 &&
+        file[file.length () - 8] == '-' &&
         file.find (".data") == file.length () - 5)
     {
       auto basename = Path (file).name ();
@@ -30,31 +30,45 @@
 #include <Datafile.h>
 #include <Interval.h>
 #include <Journal.h>
+#include <LogFile.h>
 #include <Range.h>
+#include <StableIdIndex.h>
+#include <StateFile.h>
 #include <TagInfoDatabase.h>
 #include <Transaction.h>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 class Database
 {
+  // The catalog of data files, keyed and therefore ordered by (year, month).
+  typedef std::map <std::pair <int, int>, Datafile> catalog;
+
 public:
 
   class iterator
   {
   private:
     friend class Database;
-    typedef std::vector <Datafile>::reverse_iterator files_iterator;
-    typedef std::vector <std::string>::const_reverse_iterator lines_iterator;
-    typedef std::string value_type;
+    typedef catalog::reverse_iterator files_iterator;
+    typedef std::string_view value_type;
 
     files_iterator files_it;
     files_iterator files_end;
 
-    lines_iterator lines_it;
-    lines_iterator lines_end;
+    // The number of lines in the current file that have not been visited yet,
+    // including the current line, which is at index lines_left - 1.
+    size_t lines_left {0};
 
     iterator (files_iterator fbegin, files_iterator fend);
+    void skipEmptyFiles ();
 
   public:
     iterator& operator++ ();
@@ -64,15 +78,18 @@ public:
     bool operator!= (const iterator & other) const;
     const value_type& operator* () const;
     const value_type* operator-> () const;
+    Interval interval () const;
+    size_t skipFrom (const Datetime&);
+    size_t skip (size_t);
   };
 
   class reverse_iterator
   {
   private:
     friend class Database;
-    typedef std::vector <Datafile>::iterator files_iterator;
-    typedef std::vector <std::string>::const_iterator lines_iterator;
-    typedef std::string value_type;
+    typedef catalog::iterator files_iterator;
+    typedef std::vector <std::string_view>::const_iterator lines_iterator;
+    typedef std::string_view value_type;
 
     files_iterator files_it;
     files_iterator files_end;
@@ -92,9 +109,34 @@ public:
     const value_type* operator-> () const;
   };
 
+  // Collects changes to many intervals, which Database::apply makes in one
+  // pass over each affected data file, and records as a single undo action.
+  // Changes that cancel each other out are dropped, such as adding an
+  // interval and deleting it again.
+  class WriteBatch
+  {
+  private:
+    friend class Database;
+
+    struct Changes
+    {
+      std::unordered_multimap <std::string, Interval> deleted {};
+      std::unordered_multimap <std::string, Interval> added {};
+    };
+
+    // Changes grouped by the (year, month) of the data file they go to.
+    std::map <std::pair <int, int>, Changes> _changes {};
+
+  public:
+    void addInterval (const Interval&);
+    void deleteInterval (const Interval&);
+    void modifyInterval (const Interval&, const Interval&);
+  };
+
 public:
   Database () = default;
-  void initialize (const std::string&, Journal& journal);
+  void initialize (const std::string&, Journal& journal, bool stableIds);
+  void initializeState (const std::vector <std::string>&, bool);
   void commit ();
   std::vector <std::string> files () const;
   std::set <std::string> tags () const;
@@ -104,6 +146,8 @@ public:
   void addInterval (const Interval&, bool verbose);
   void deleteInterval (const Interval&);
   void modifyInterval (const Interval&, const Interval &, bool verbose);
+  void apply (WriteBatch&, bool verbose);
+  size_t positionOf (uint64_t);
 
   std::string dump () const;
 
@@ -114,16 +158,44 @@ public:
   reverse_iterator rend ();
 
 private:
-  unsigned int getDatafile (int, int);
-  std::vector <Range> segmentRange (const Range&);
+  Datafile& getDatafile (int, int);
+  size_t positionIn (int, int, uint64_t);
+  void assignStableId (Interval&);
+  void releaseStableId (const Interval&);
+  void countTags (const Interval&, bool);
+  void uncountTags (const Interval&);
   void initializeDatafiles ();
   void initializeTagDatabase ();
+  void rebuildTagDatabase ();
+  void loadTagLog ();
+  void writeTagCheckpoint ();
+  void writeState ();
 
 private:
   std::string               _location {};
-  std::vector <Datafile>    _files    {};
+  catalog                   _files    {};
+  bool                      _files_initialized {false};
   TagInfoDatabase           _tagInfoDatabase {};
+
+  // Changes to tag counts are appended to tags.log, which starts with the
+  // checksum of the tags.data it extends. Once the log outgrows tags.data,
+  // the tags are written to tags.data in full instead.
+  std::string               _tagCheckpoint {};
+  std::unique_ptr <LogFile> _tagLog {};
+  bool                      _tagLogValid {false};
+  size_t                    _tagLogEntries {0};
   Journal*                  _journal {};
+
+  // Stable ids of intervals deleted by this command, which the intervals that
+  // replace them take over.
+  StableIdIndex             _stableIds {};
+  bool                      _assignStableIds {false};
+  std::set <uint64_t>       _releasedIds {};
+
+  // Whether any interval changed, so that the state file is out of date.
+  StateFile                 _state {};
+  bool                      _stateEnabled {false};
+  bool                      _modified {false};
 };
 
 #endif
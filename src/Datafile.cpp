@@ -30,14 +30,95 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdlib>
+#include <fcntl.h>
 #include <format.h>
+#include <mutex>
 #include <sstream>
+#include <sys/stat.h>
 #include <timew.h>
+#include <unistd.h>
+
+// The size of the blocks in which the end of a file is read.
+static const off_t TAIL_BLOCK_SIZE = 4096;
+
+////////////////////////////////////////////////////////////////////////////////
+// Reads the file backwards from its end, a block at a time, until it finds the
+// last inclusion line. The rest of the file is never read. Returns false if
+// the file cannot be read this way.
+static bool readLastInclusion (const Path& path, std::string& line)
+{
+  int fd = ::open (path._data.c_str (), O_RDONLY);
+  if (fd == -1)
+  {
+    return false;
+  }
+
+  struct stat s;
+  if (::fstat (fd, &s) || ! S_ISREG (s.st_mode))
+  {
+    ::close (fd);
+    return false;
+  }
+
+  // The tail holds the file from offset to its end. Lines that end at or
+  // before end have been examined already.
+  std::string tail;
+  off_t offset = s.st_size;
+  size_t end = 0;
+
+  line.clear ();
+  while (offset > 0)
+  {
+    auto length = std::min (offset, TAIL_BLOCK_SIZE);
+    offset -= length;
+
+    std::string block (length, '\0');
+    for (off_t done = 0; done < length; )
+    {
+      auto got = ::pread (fd, &block[done], length - done, offset + done);
+      if (got <= 0)
+      {
+        ::close (fd);
+        return false;
+      }
+
+      done += got;
+    }
+
+    tail.insert (0, block);
+    end += length;
+
+    // Only lines that start within the tail are complete, unless the tail
+    // reaches the start of the file.
+    while (end > 0)
+    {
+      auto newline = tail.rfind ('\n', end - 1);
+      if (newline == std::string::npos && offset > 0)
+      {
+        break;
+      }
+
+      auto start = newline == std::string::npos ? 0 : newline + 1;
+      if (start < end && tail[start] == 'i')
+      {
+        line = tail.substr (start, end - start);
+        ::close (fd);
+        return true;
+      }
+
+      end = newline == std::string::npos ? 0 : newline;
+    }
+  }
+
+  ::close (fd);
+  return true;
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 void Datafile::initialize (const std::string& name)
 {
   _file = Path (name);
+  _index_file = Path (name.substr (0, name.rfind (".data")) + ".idx");
 
   // From the name, which is of the form YYYY-MM.data, extract the YYYY and MM.
   auto basename = _file.name ();
@@ -63,29 +144,129 @@ std::string Datafile::name () const
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Identifies the last incluѕion (^i) lines
+// The month covered by this file.
+Range Datafile::range () const
+{
+  return _range;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Identifies the last incluѕion (^i) lines. Unless the lines are loaded
+// already, only the end of the file is read.
 std::string Datafile::lastLine ()
 {
   if (! _lines_loaded)
+  {
+    std::string line;
+    if (readLastInclusion (_file, line))
+      return line;
+
     load_lines ();
+  }
 
-  std::vector <std::string>::reverse_iterator ri;
+  compact ();
+
+  std::vector <std::string_view>::reverse_iterator ri;
   for (ri = _lines.rbegin (); ri != _lines.rend (); ri++)
-    if (ri->operator[] (0) == 'i')
-      return *ri;
+    if (! ri->empty () && ri->front () == 'i')
+      return std::string (*ri);
 
   return "";
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-const std::vector <std::string>& Datafile::allLines ()
+const std::vector <std::string_view>& Datafile::allLines ()
 {
   if (! _lines_loaded)
     load_lines ();
 
+  compact ();
   return _lines;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+size_t Datafile::count ()
+{
+  if (! _dirty)
+  {
+    load_index ();
+    if (_index.valid ())
+    {
+      return _index.size ();
+    }
+  }
+
+  return allLines ().size ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Returns the interval stored in the given line. As long as the file is
+// unmodified, it is taken from the index, and the text of the line is only
+// read if the interval has an annotation or a stable id.
+Interval Datafile::interval (size_t index)
+{
+  if (! _dirty)
+  {
+    load_index ();
+    if (_index.valid ())
+    {
+      auto interval = _index.interval (index);
+      if (_index.entry (index).flags & DatafileIndex::annotated)
+      {
+        interval.annotation = IntervalFactory::fromSerialization (allLines ()[index]).annotation;
+      }
+
+      if (_index.entry (index).flags & DatafileIndex::identified)
+      {
+        interval.uid = IntervalFactory::stableId (allLines ()[index]);
+      }
+
+      return interval;
+    }
+  }
+
+  return IntervalFactory::fromSerialization (allLines ()[index]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The size and modification time of the file, as used to tell whether the
+// index is stale.
+bool Datafile::signature (uint64_t& size, int64_t& mtime) const
+{
+  return DatafileIndex::signature (_file, size, mtime);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Adds the number of intervals carrying each tag id to the counts. Neither
+// annotations nor, for indexed months, the text of the lines are read.
+void Datafile::countTags (std::map <unsigned int, unsigned int>& counts)
+{
+  if (! _dirty)
+  {
+    load_index ();
+    if (_index.valid ())
+    {
+      for (size_t i = 0; i < _index.size (); ++i)
+      {
+        for (auto id : _index.interval (i).tagIds ())
+        {
+          ++counts[id];
+        }
+      }
+
+      return;
+    }
+  }
+
+  for (auto& line : allLines ())
+  {
+    for (auto id : IntervalFactory::fromSerialization (line).tagIds ())
+    {
+      ++counts[id];
+    }
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Accepted intervals;   day1 <= interval.start < dayN
 void Datafile::addInterval (const Interval& interval)
@@ -110,8 +291,13 @@ void Datafile::addInterval (const Interval& interval)
                      interval.dump (), test.dump ()));
     }
 
-    _lines.push_back (serialization);
-    debug (format ("{1}: Added {2}", _file.name (), _lines.back ()));
+    _lines.push_back (own (serialization));
+    if (_slots_built)
+    {
+      _slots.emplace (_lines.back (), _lines.size () - 1);
+    }
+
+    debug (format ("{1}: Added {2}", _file.name (), serialization));
     _dirty = true;
   }
   catch (const std::string& error)
@@ -132,16 +318,29 @@ void Datafile::deleteInterval (const Interval& interval)
     load_lines ();
   }
 
-  auto serialized = interval.serialize ();
-  auto i = std::find (_lines.begin (), _lines.end (), serialized);
-  if (i == _lines.end ())
+  remove_line (interval.serialize ());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Deletes the lines with the given serializations, and adds intervals.
+void Datafile::update (
+  const std::vector <std::string>& deleted,
+  const std::vector <Interval>& added)
+{
+  if (! _lines_loaded)
+  {
+    load_lines ();
+  }
+
+  for (auto& serialization : deleted)
   {
-    throw format ("Datafile::deleteInterval failed to find '{1}'", serialized);
+    remove_line (serialization);
   }
 
-  _lines.erase (i);
-  _dirty = true;
-  debug (format ("{1}: Deleted {2}", _file.name (), serialized));
+  for (auto& interval : added)
+  {
+    addInterval (interval);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -150,19 +349,49 @@ void Datafile::commit ()
   // The _dirty flag indicates that the file needs to be written.
   if (_dirty)
   {
+    compact ();
+
     AtomicFile file (_file);
     if (!_lines.empty ())
     {
       if (file.open ())
       {
-        // Sort the intervals by ascending start time.
+        // Sort the intervals by ascending start time, which moves the slots.
         std::sort (_lines.begin (), _lines.end ());
+        _slots.clear ();
+        _slots_built = false;
 
-        // Write out all the lines.
-        file.truncate ();
-        for (auto& line : _lines)
+        // Usually only the newest lines changed, in which case the lines
+        // before them are cloned rather than written again. The file is
+        // still replaced by renaming, as readers may have it mapped. If
+        // another process replaced the file since it was mapped, the lines
+        // are all written, as before.
+        bool cloned = false;
+        auto unchanged = unchanged_lines ();
+        if (unchanged > 0)
         {
-          file.write_raw (line + '\n');
+          auto content = _mapping->content ();
+          auto& last = _lines[unchanged - 1];
+          auto offset = last.data () + last.size () + 1 - content.data ();
+
+          std::string tail;
+          for (auto i = unchanged; i < _lines.size (); ++i)
+          {
+            tail.append (_lines[i].data (), _lines[i].size ());
+            tail += '\n';
+          }
+
+          cloned = file.copy_with_tail (offset, tail, content.size (), _mapping->mtime ());
+        }
+
+        if (! cloned)
+        {
+          // Write out all the lines.
+          file.truncate ();
+          for (auto& line : _lines)
+          {
+            file.write_raw (std::string (line) + '\n');
+          }
         }
 
         _dirty = false;
@@ -176,6 +405,16 @@ void Datafile::commit ()
     {
       file.remove ();
     }
+
+    // The index describes the file as it was, and is rebuilt on the next read.
+    // The in-memory index no longer matches the sorted lines either.
+    if (_index_file.exists ())
+    {
+      AtomicFile (_index_file).remove ();
+    }
+
+    _index.clear ();
+    _index_loaded = true;
   }
 }
 
@@ -186,8 +425,9 @@ std::string Datafile::dump () const
   out << "Datafile\n"
       << "  Name:        " << _file.name () << (_file.exists () ? "" : " (does not exist)") << '\n'
       << "  dirty:       " << (_dirty ? "true" : "false") << '\n'
-      << "  lines:       " << _lines.size () << '\n'
+      << "  lines:       " << _lines.size () - _removed_count << '\n'
       << "    loaded     " << (_lines_loaded ? "true" : "false") << '\n'
+      << "  index:       " << (_index.valid () ? std::to_string (_index.size ()) + " entries" : "none") << '\n'
       << "  range:       " << _range.start.toISO () << " - "
                            << _range.end.toISO () << '\n';
 
@@ -195,8 +435,41 @@ std::string Datafile::dump () const
 }
 
 ////////////////////////////////////////////////////////////////////////////////
+// The file is mapped into memory, and the lines are views into the mapping,
+// so loading costs neither a copy nor an allocation per line.
 void Datafile::load_lines ()
 {
+  auto mapping = std::make_shared <MappedFile> ();
+  if (mapping->open (_file))
+  {
+    auto content = mapping->content ();
+    auto count = _lines.size ();
+
+    std::string_view::size_type start = 0;
+    while (start < content.size ())
+    {
+      auto end = content.find ('\n', start);
+      if (end == std::string_view::npos)
+      {
+        end = content.size ();
+      }
+
+      _lines.push_back (content.substr (start, end - start));
+      start = end + 1;
+    }
+
+    _mapping = mapping;
+    _lines_loaded = true;
+    debug (format ("{1}: {2} intervals", _file.name (), _lines.size () - count));
+    return;
+  }
+
+  // If the file cannot be mapped, read it into owned strings instead. Files
+  // may be loaded from several threads while the tag database is rebuilt, and
+  // AtomicFile keeps a process-wide registry.
+  static std::mutex atomic_file_mutex;
+  std::lock_guard <std::mutex> lock (atomic_file_mutex);
+
   AtomicFile file (_file);
   if (file.open ())
   {
@@ -207,7 +480,7 @@ void Datafile::load_lines ()
 
     // Append the lines that were read.
     for (auto& line : read_lines)
-      _lines.push_back (line);
+      _lines.push_back (own (line));
 
     _lines_loaded = true;
     debug (format ("{1}: {2} intervals", file.name (), read_lines.size ()));
@@ -215,3 +488,158 @@ void Datafile::load_lines ()
 }
 
 ////////////////////////////////////////////////////////////////////////////////
+// Loads the sidecar index, rebuilding it from the text of the data file if it
+// is missing or stale. Only months that are over are indexed, since the
+// current month changes with almost every write, which invalidates the index.
+void Datafile::load_index ()
+{
+  if (_index_loaded)
+  {
+    return;
+  }
+
+  _index_loaded = true;
+  if (_range.end > Datetime ())
+  {
+    return;
+  }
+
+  if (_index.load (_index_file, _file))
+  {
+    return;
+  }
+
+  if (! _lines_loaded)
+  {
+    load_lines ();
+  }
+
+  if (_lines_loaded)
+  {
+    // A malformed line is reported when it is actually read, not here. The
+    // index is only saved for lines read from a mapping, which knows the size
+    // and modification time of the file they came from.
+    try
+    {
+      _index.build (_lines);
+      if (_mapping)
+      {
+        _index.save (_index_file, _mapping->content ().size (), _mapping->mtime ());
+      }
+    }
+    catch (const std::string& error)
+    {
+      debug (format ("{1}: Cannot index: {2}", _file.name (), error));
+      _index.clear ();
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Counts the leading lines that are still exactly where they are in the mapped
+// file, each followed by a newline. These do not need to be written again.
+size_t Datafile::unchanged_lines () const
+{
+  if (! _mapping)
+  {
+    return 0;
+  }
+
+  auto content = _mapping->content ();
+  auto next = content.data ();
+  auto end = content.data () + content.size ();
+
+  size_t count = 0;
+  while (count < _lines.size () &&
+         _lines[count].data () == next &&
+         next + _lines[count].size () < end)
+  {
+    next += _lines[count].size () + 1;
+    ++count;
+  }
+
+  return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The line is found through its slot, and only marked as removed, so that
+// deleting many intervals costs a single pass over the lines in compact.
+void Datafile::remove_line (const std::string& serialization)
+{
+  build_slots ();
+
+  auto found = _slots.find (serialization);
+  if (found == _slots.end ())
+  {
+    throw format ("Datafile::deleteInterval failed to find '{1}'", serialization);
+  }
+
+  if (_removed.size () < _lines.size ())
+  {
+    _removed.resize (_lines.size (), false);
+  }
+
+  _removed[found->second] = true;
+  ++_removed_count;
+  _slots.erase (found);
+
+  _dirty = true;
+  debug (format ("{1}: Deleted {2}", _file.name (), serialization));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Datafile::build_slots ()
+{
+  if (_slots_built)
+  {
+    return;
+  }
+
+  _slots.reserve (_lines.size ());
+  for (size_t i = 0; i < _lines.size (); ++i)
+  {
+    if (i >= _removed.size () || ! _removed[i])
+    {
+      _slots.emplace (_lines[i], i);
+    }
+  }
+
+  _slots_built = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Drops the lines marked as removed. The slots of the remaining lines move, so
+// they are looked up again on the next deletion.
+void Datafile::compact ()
+{
+  if (_removed_count == 0)
+  {
+    return;
+  }
+
+  size_t kept = 0;
+  for (size_t i = 0; i < _lines.size (); ++i)
+  {
+    if (i >= _removed.size () || ! _removed[i])
+    {
+      _lines[kept++] = _lines[i];
+    }
+  }
+
+  _lines.resize (kept);
+  _removed.clear ();
+  _removed_count = 0;
+  _slots.clear ();
+  _slots_built = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Keeps a line that was not read from the file alive for as long as the
+// Datafile, and returns a view of it.
+std::string_view Datafile::own (std::string line)
+{
+  _owned_lines->push_back (std::move (line));
+  return _owned_lines->back ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -27,10 +27,17 @@
 #ifndef INCLUDED_DATAFILE
 #define INCLUDED_DATAFILE
 
+#include <DatafileIndex.h>
 #include <FS.h>
 #include <Interval.h>
+#include <MappedFile.h>
 #include <Range.h>
+#include <deque>
+#include <map>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 class Datafile
@@ -39,25 +46,54 @@ public:
   Datafile () = default;
   void initialize (const std::string&);
   std::string name () const;
+  Range range () const;
 
   std::string lastLine ();
-  const std::vector <std::string>& allLines ();
+  const std::vector <std::string_view>& allLines ();
+  size_t count ();
+  Interval interval (size_t);
+  bool signature (uint64_t&, int64_t&) const;
+  void countTags (std::map <unsigned int, unsigned int>&);
 
   void addInterval (const Interval&);
   void deleteInterval (const Interval&);
+  void update (const std::vector <std::string>&, const std::vector <Interval>&);
   void commit ();
 
   std::string dump () const;
 
 private:
   void load_lines ();
+  void load_index ();
+  size_t unchanged_lines () const;
+  void remove_line (const std::string&);
+  void build_slots ();
+  void compact ();
+  std::string_view own (std::string);
 
 private:
   Path                      _file         {};
+  Path                      _index_file   {};
+  DatafileIndex             _index        {};
+  bool                      _index_loaded {false};
   bool                      _dirty        {false};
-  std::vector <std::string> _lines        {};
+  std::vector <std::string_view> _lines   {};
   bool                      _lines_loaded {false};
   Range                     _range        {};
+
+  // Deleted lines are only marked as removed, and dropped together before the
+  // lines are next used. The slot of each remaining line is looked up by its
+  // text, once there has been a deletion.
+  std::unordered_multimap <std::string_view, size_t> _slots {};
+  bool                      _slots_built  {false};
+  std::vector <bool>        _removed      {};
+  size_t                    _removed_count {0};
+
+  // Lines are views into the mapped file, or into owned strings for lines that
+  // were added in this session. Both are shared, so that the views in a copy
+  // of a Datafile remain valid.
+  std::shared_ptr <MappedFile>               _mapping     {};
+  std::shared_ptr <std::deque <std::string>> _owned_lines {std::make_shared <std::deque <std::string>> ()};
 };
 
 #endif
@@ -0,0 +1,332 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <DatafileIndex.h>
+#include <IntervalFactory.h>
+#include <TagDictionary.h>
+#include <cstdio>
+#include <cstring>
+#include <format.h>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <sys/stat.h>
+#include <timew.h>
+#include <unistd.h>
+
+static const char     INDEX_MAGIC[4]  = {'T', 'W', 'I', 'X'};
+static const uint32_t INDEX_VERSION   = 1;
+static const uint32_t INDEX_BYTEORDER = 0x01020304;
+
+static_assert (sizeof (DatafileIndex::Entry) == 40, "DatafileIndex::Entry must not be padded");
+
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+static void writeValue (std::string& out, const T& value)
+{
+  out.append (reinterpret_cast <const char*> (&value), sizeof (T));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+static bool readValue (const std::string& in, std::string::size_type& cursor, T& value)
+{
+  if (cursor + sizeof (T) > in.size ())
+  {
+    return false;
+  }
+
+  std::memcpy (&value, in.data () + cursor, sizeof (T));
+  cursor += sizeof (T);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Loads the index, but only if it was built from the data file as it is now.
+bool DatafileIndex::load (const Path& index, const Path& data)
+{
+  clear ();
+
+  uint64_t data_size;
+  int64_t data_mtime;
+  if (! signature (data, data_size, data_mtime))
+  {
+    return false;
+  }
+
+  std::ifstream in (index._data, std::ios::in | std::ios::binary);
+  if (! in.good ())
+  {
+    return false;
+  }
+
+  std::stringstream buffer;
+  buffer << in.rdbuf ();
+  const std::string content = buffer.str ();
+
+  std::string::size_type cursor = 0;
+  char magic[4];
+  uint32_t version, byteorder, num_entries, num_tags, num_tag_refs;
+  uint64_t size;
+  int64_t mtime;
+
+  if (! readValue (content, cursor, magic)        ||
+      std::memcmp (magic, INDEX_MAGIC, 4) != 0      ||
+      ! readValue (content, cursor, version)      || version   != INDEX_VERSION   ||
+      ! readValue (content, cursor, byteorder)    || byteorder != INDEX_BYTEORDER ||
+      ! readValue (content, cursor, size)         || size      != data_size       ||
+      ! readValue (content, cursor, mtime)        || mtime     != data_mtime      ||
+      ! readValue (content, cursor, num_entries)  ||
+      ! readValue (content, cursor, num_tags)     ||
+      ! readValue (content, cursor, num_tag_refs))
+  {
+    debug (format ("{1}: Index is stale", index.name ()));
+    return false;
+  }
+
+  _tags.reserve (num_tags);
+  for (uint32_t i = 0; i < num_tags; ++i)
+  {
+    uint32_t length;
+    if (! readValue (content, cursor, length) ||
+        cursor + length > content.size ())
+    {
+      clear ();
+      return false;
+    }
+
+    _tags.emplace_back (content, cursor, length);
+    _tag_ids.push_back (TagDictionary::id (_tags.back ()));
+    cursor += length;
+  }
+
+  if (cursor + num_entries * sizeof (Entry) + num_tag_refs * sizeof (uint32_t) != content.size ())
+  {
+    clear ();
+    return false;
+  }
+
+  _entries.resize (num_entries);
+  std::memcpy (_entries.data (), content.data () + cursor, num_entries * sizeof (Entry));
+  cursor += num_entries * sizeof (Entry);
+
+  _tag_refs.resize (num_tag_refs);
+  std::memcpy (_tag_refs.data (), content.data () + cursor, num_tag_refs * sizeof (uint32_t));
+
+  for (auto& entry : _entries)
+  {
+    if (entry.tags_offset + entry.tags_count > num_tag_refs)
+    {
+      clear ();
+      return false;
+    }
+  }
+
+  for (auto& ref : _tag_refs)
+  {
+    if (ref >= num_tags)
+    {
+      clear ();
+      return false;
+    }
+  }
+
+  _valid = true;
+  debug (format ("{1}: {2} indexed intervals", index.name (), _entries.size ()));
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The index is a cache, so failing to write it is not an error. It is written
+// to a temporary file first, so a concurrent reader never sees a partial file.
+//
+// The size and modification time must be those of the data file the index was
+// built from, as it was read, not as it is now: another process may have
+// replaced it since.
+bool DatafileIndex::save (const Path& index, uint64_t data_size, int64_t data_mtime) const
+{
+  if (! _valid)
+  {
+    return false;
+  }
+
+  std::string out;
+  out.reserve (64 + _entries.size () * sizeof (Entry) + _tag_refs.size () * sizeof (uint32_t));
+  out.append (INDEX_MAGIC, 4);
+  writeValue (out, INDEX_VERSION);
+  writeValue (out, INDEX_BYTEORDER);
+  writeValue (out, data_size);
+  writeValue (out, data_mtime);
+  writeValue (out, static_cast <uint32_t> (_entries.size ()));
+  writeValue (out, static_cast <uint32_t> (_tags.size ()));
+  writeValue (out, static_cast <uint32_t> (_tag_refs.size ()));
+
+  for (auto& tag : _tags)
+  {
+    writeValue (out, static_cast <uint32_t> (tag.size ()));
+    out.append (tag);
+  }
+
+  out.append (reinterpret_cast <const char*> (_entries.data ()), _entries.size () * sizeof (Entry));
+  out.append (reinterpret_cast <const char*> (_tag_refs.data ()), _tag_refs.size () * sizeof (uint32_t));
+
+  std::stringstream temp;
+  temp << index._data << '.' << ::getpid () << ".tmp";
+
+  {
+    std::ofstream file (temp.str (), std::ios::out | std::ios::binary | std::ios::trunc);
+    file.write (out.data (), out.size ());
+    if (! file.good ())
+    {
+      std::remove (temp.str ().c_str ());
+      return false;
+    }
+  }
+
+  if (std::rename (temp.str ().c_str (), index._data.c_str ()))
+  {
+    std::remove (temp.str ().c_str ());
+    return false;
+  }
+
+  debug (format ("{1}: Wrote index of {2} intervals", index.name (), _entries.size ()));
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Decode every line once, recording where it lives in the data file.
+void DatafileIndex::build (const std::vector <std::string_view>& lines)
+{
+  clear ();
+
+  std::map <unsigned int, uint32_t> tag_refs;
+  uint64_t offset = 0;
+
+  _entries.reserve (lines.size ());
+  for (auto& line : lines)
+  {
+    Interval interval = IntervalFactory::fromSerialization (line);
+
+    Entry entry;
+    entry.start       = interval.start.toEpoch ();
+    entry.end         = interval.end.toEpoch ();
+    entry.offset      = offset;
+    entry.length      = line.size ();
+    entry.tags_offset = _tag_refs.size ();
+    entry.tags_count  = interval.tagIds ().size ();
+    entry.flags       = (interval.annotation.empty () ? 0 : annotated) |
+                        (interval.uid == 0 ? 0 : identified);
+
+    for (auto id : interval.tagIds ())
+    {
+      auto it = tag_refs.find (id);
+      if (it == tag_refs.end ())
+      {
+        it = tag_refs.emplace (id, _tags.size ()).first;
+        _tags.push_back (TagDictionary::name (id));
+        _tag_ids.push_back (id);
+      }
+
+      _tag_refs.push_back (it->second);
+    }
+
+    _entries.push_back (entry);
+    offset += line.size () + 1;
+  }
+
+  _valid = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DatafileIndex::clear ()
+{
+  _valid = false;
+  _entries.clear ();
+  _tags.clear ();
+  _tag_ids.clear ();
+  _tag_refs.clear ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool DatafileIndex::valid () const
+{
+  return _valid;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+size_t DatafileIndex::size () const
+{
+  return _entries.size ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const DatafileIndex::Entry& DatafileIndex::entry (size_t index) const
+{
+  return _entries[index];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reconstructs the interval at the given position, except for the annotation,
+// which is only available from the text of the line.
+Interval DatafileIndex::interval (size_t index) const
+{
+  const auto& entry = _entries[index];
+
+  Interval interval;
+  interval.start = Datetime (entry.start);
+  interval.end   = Datetime (entry.end);
+
+  std::vector <unsigned int> ids;
+  ids.reserve (entry.tags_count);
+  for (uint32_t i = entry.tags_offset; i < entry.tags_offset + entry.tags_count; ++i)
+  {
+    ids.push_back (_tag_ids[_tag_refs[i]]);
+  }
+
+  interval.setTagIds (std::move (ids));
+
+  return interval;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool DatafileIndex::signature (const Path& path, uint64_t& size, int64_t& mtime)
+{
+  struct stat s;
+  if (::stat (path._data.c_str (), &s))
+  {
+    return false;
+  }
+
+  size = s.st_size;
+#ifdef __APPLE__
+  mtime = static_cast <int64_t> (s.st_mtimespec.tv_sec) * 1000000000 + s.st_mtimespec.tv_nsec;
+#else
+  mtime = static_cast <int64_t> (s.st_mtim.tv_sec) * 1000000000 + s.st_mtim.tv_nsec;
+#endif
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
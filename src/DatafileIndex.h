@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_DATAFILEINDEX
+#define INCLUDED_DATAFILEINDEX
+
+#include <FS.h>
+#include <Interval.h>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A DatafileIndex is a binary sidecar (YYYY-MM.idx) for a YYYY-MM.data file.
+// It holds the pre-decoded start/end epochs, tags and byte offsets of every
+// line, so that intervals can be reconstructed without running the lines
+// through the Lexer. The index is only a cache, and is discarded whenever the
+// size or modification time of the data file no longer matches.
+class DatafileIndex
+{
+public:
+  struct Entry
+  {
+    int64_t  start       {0};
+    int64_t  end         {0};
+    uint64_t offset      {0};
+    uint32_t length      {0};
+    uint32_t tags_offset {0};
+    uint32_t tags_count  {0};
+    uint32_t flags       {0};
+  };
+
+  static const uint32_t annotated = 0x1;
+  static const uint32_t identified = 0x2;
+
+  DatafileIndex () = default;
+
+  bool load (const Path&, const Path&);
+  bool save (const Path&, uint64_t, int64_t) const;
+  void build (const std::vector <std::string_view>&);
+  void clear ();
+
+  bool valid () const;
+  size_t size () const;
+  const Entry& entry (size_t) const;
+  Interval interval (size_t) const;
+
+  static bool signature (const Path&, uint64_t&, int64_t&);
+
+private:
+  bool                      _valid    {false};
+  std::vector <Entry>       _entries  {};
+  std::vector <std::string> _tags     {};
+  std::vector <unsigned int> _tag_ids {};
+  std::vector <uint32_t>    _tag_refs {};
+};
+
+#endif
@@ -0,0 +1,126 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <DayBuckets.h>
+#include <cassert>
+
+////////////////////////////////////////////////////////////////////////////////
+DayBuckets::DayBuckets (
+  const IntervalColumns& intervals,
+  const std::vector <Range>& days)
+{
+  std::vector <int64_t> starts;
+  std::vector <int64_t> ends;
+  starts.reserve (intervals.size ());
+  ends.reserve (intervals.size ());
+
+  for (size_t i = 0; i < intervals.size (); ++i)
+  {
+    starts.push_back (intervals.start (i));
+    ends.push_back (intervals.end (i));
+  }
+
+  assign (starts, ends, days);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+DayBuckets::DayBuckets (
+  const std::vector <Range>& ranges,
+  const std::vector <Range>& days)
+{
+  std::vector <int64_t> starts;
+  std::vector <int64_t> ends;
+  starts.reserve (ranges.size ());
+  ends.reserve (ranges.size ());
+
+  for (auto& range : ranges)
+  {
+    starts.push_back (range.start.toEpoch ());
+    ends.push_back (range.end.toEpoch ());
+  }
+
+  assign (starts, ends, days);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+size_t DayBuckets::size () const
+{
+  return _offsets.size () - 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+DayBuckets::Bucket DayBuckets::bucket (size_t day) const
+{
+  assert (day < size ());
+  return {_indices.data () + _offsets[day], _indices.data () + _offsets[day + 1]};
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Intervals join the active set once the day they start in is reached, and
+// leave it before the first day they no longer reach. Each day is then the
+// active set, so every interval is visited only on its own days. An end of
+// zero is an open interval, and a start of zero one that never started.
+void DayBuckets::assign (
+  const std::vector <int64_t>& starts,
+  const std::vector <int64_t>& ends,
+  const std::vector <Range>& days)
+{
+  std::vector <size_t> active;
+  size_t next = 0;
+
+  _offsets.reserve (days.size () + 1);
+
+  for (auto& day : days)
+  {
+    const auto day_start = day.start.toEpoch ();
+    const auto day_end = day.end.toEpoch ();
+
+    for (; next < starts.size () && starts[next] < day_end; ++next)
+    {
+      if (starts[next] > 0)
+      {
+        active.push_back (next);
+      }
+    }
+
+    size_t kept = 0;
+    for (auto index : active)
+    {
+      if (ends[index] == 0 ||
+          ends[index] > day_start ||
+          starts[index] == day_start)
+      {
+        active[kept++] = index;
+      }
+    }
+    active.resize (kept);
+
+    _indices.insert (_indices.end (), active.begin (), active.end ());
+    _offsets.push_back (_indices.size ());
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
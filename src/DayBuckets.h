@@ -0,0 +1,72 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_DAYBUCKETS
+#define INCLUDED_DAYBUCKETS
+
+#include <IntervalColumns.h>
+#include <Range.h>
+#include <cstdint>
+#include <vector>
+
+// Assigns intervals to the days they intersect, in one pass over both. The
+// intervals must be sorted by start, and the days by time, without overlap.
+// An interval is assigned to every day it reaches into, so one that crosses
+// midnight, or is still open, is found on each of its days.
+//
+// As with Range::intersects, a zero-width interval at the start of a day is
+// assigned to that day.
+class DayBuckets
+{
+public:
+  // The indices of the intervals of one day, in their order.
+  struct Bucket
+  {
+    const size_t* first;
+    const size_t* last;
+
+    const size_t* begin () const { return first; }
+    const size_t* end () const { return last; }
+    size_t size () const { return last - first; }
+    bool empty () const { return first == last; }
+  };
+
+  DayBuckets (const IntervalColumns&, const std::vector <Range>&);
+  DayBuckets (const std::vector <Range>&, const std::vector <Range>&);
+
+  size_t size () const;
+  Bucket bucket (size_t) const;
+
+private:
+  void assign (const std::vector <int64_t>&, const std::vector <int64_t>&, const std::vector <Range>&);
+
+private:
+  // The intervals of day i are at [offsets[i], offsets[i + 1]).
+  std::vector <size_t> _offsets {0};
+  std::vector <size_t> _indices {};
+};
+
+#endif
@@ -30,6 +30,21 @@
 #include <algorithm>
 #include <format.h>
 #include <shared.h>
+#include <timew.h>
+
+static const int SECONDS_PER_DAY = 86400;
+
+////////////////////////////////////////////////////////////////////////////////
+// The local time at the given number of seconds into the given day. Each
+// point is converted on its own, so a block is right on days that change to
+// or from daylight saving time.
+static Datetime localTime (int days, int seconds)
+{
+  int y, m, d;
+  civilFromDays (days + seconds / SECONDS_PER_DAY, y, m, d);
+  seconds %= SECONDS_PER_DAY;
+  return Datetime (y, m, d, seconds / 3600, (seconds / 60) % 60, seconds % 60);
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 // An exclusion represents untrackable time such as holidays, weekends, evenings
@@ -76,6 +91,12 @@ Exclusion::Exclusion (const std::string& name, const std::string& value)
     else if (Datetime::dayOfWeek (_tokens[1]) != -1)
     {
       _additive = false;
+      _dayOfWeek = Datetime::dayOfWeek (_tokens[1]);
+
+      // The time blocks are parsed once, not for every day they apply to.
+      for (unsigned int block = 2; block < _tokens.size (); ++block)
+        _blocks.push_back (parseTimeBlock (_tokens[block]));
+
       return;
     }
   }
@@ -100,7 +121,6 @@ std::vector <std::string> Exclusion::tokens () const
 std::vector <Range> Exclusion::ranges (const Range& range) const
 {
   std::vector <Range> results;
-  int dayOfWeek;
 
   if (_tokens[1] == "days" &&
       (_tokens[3] == "on" ||
@@ -116,10 +136,8 @@ std::vector <Range> Exclusion::ranges (const Range& range) const
       results.push_back (all_day);
   }
 
-  else if ((dayOfWeek = Datetime::dayOfWeek (_tokens[1])) != -1)
+  else if (_dayOfWeek != -1)
   {
-    Datetime start (range.start.year (), range.start.month (), range.start.day (), 0, 0, 0);
-
     Range myRange = {range};
 
     if (myRange.is_open())
@@ -127,24 +145,20 @@ std::vector <Range> Exclusion::ranges (const Range& range) const
       myRange.end = Datetime();
     }
 
-    while (start <= myRange.end)
+    // Only the days that match are visited, a week apart. 1970-01-01 was a
+    // Thursday.
+    auto first = daysFromCivil (range.start.year (), range.start.month (), range.start.day ());
+    auto last  = daysFromCivil (myRange.end.year (), myRange.end.month (), myRange.end.day ());
+    auto weekday = ((first + 4) % 7 + 7) % 7;
+
+    for (auto day = first + (_dayOfWeek - weekday + 7) % 7; day <= last; day += 7)
     {
-      if (start.dayOfWeek () == dayOfWeek)
+      for (auto& block : _blocks)
       {
-        Datetime end = start;
-        ++end;
-
-        // Now that 'start' and 'end' represent the correct day, compose a set
-        // of Range objects for each time block.
-        for (unsigned int block = 2; block < _tokens.size (); ++block)
-        {
-          auto r = rangeFromTimeBlock (_tokens[block], start, end);
-          if (myRange.overlaps (r))
-            results.push_back (r);
-        }
+        Range r (localTime (day, block.start), localTime (day, block.end));
+        if (myRange.overlaps (r))
+          results.push_back (r);
       }
-
-      ++start;
     }
   }
 
@@ -164,10 +178,7 @@ std::string Exclusion::dump () const
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-Range Exclusion::rangeFromTimeBlock (
-  const std::string& block,
-  const Datetime& start,
-  const Datetime& end) const
+Exclusion::Block Exclusion::parseTimeBlock (const std::string& block)
 {
   Pig pig (block);
 
@@ -175,15 +186,13 @@ Range Exclusion::rangeFromTimeBlock (
   {
     int hh, mm, ss;
     if (pig.getHMS (hh, mm, ss))
-      return Range (Datetime (start.year (), start.month (), start.day (),  0,  0,  0),
-                    Datetime (start.year (), start.month (), start.day (), hh, mm, ss));
+      return {0, hh * 3600 + mm * 60 + ss};
   }
   else if (pig.skip ('>'))
   {
     int hh, mm, ss;
     if (pig.getHMS (hh, mm, ss))
-      return Range (Datetime (start.year (), start.month (), start.day (), hh, mm, ss),
-                    Datetime (end.year (),   end.month (),   end.day (),    0,  0,  0));
+      return {hh * 3600 + mm * 60 + ss, SECONDS_PER_DAY};
   }
   else
   {
@@ -192,9 +201,7 @@ Range Exclusion::rangeFromTimeBlock (
     if (pig.getHMS (hh1, mm1, ss1) &&
         pig.skip ('-')             &&
         pig.getHMS (hh2, mm2, ss2))
-      return Range (
-               Datetime (start.year (), start.month (), start.day (), hh1, mm1, ss1),
-               Datetime (start.year (), start.month (), start.day (), hh2, mm2, ss2));
+      return {hh1 * 3600 + mm1 * 60 + ss1, hh2 * 3600 + mm2 * 60 + ss2};
   }
 
   throw format ("Malformed time block '{1}'.", block);
@@ -42,11 +42,21 @@ public:
   std::string dump () const;
 
 private:
-  Range rangeFromTimeBlock (const std::string&, const Datetime&, const Datetime&) const;
+  // A time block of a day, in seconds from its start. An end of a whole day
+  // stands for the start of the next day.
+  struct Block
+  {
+    int start;
+    int end;
+  };
+
+  static Block parseTimeBlock (const std::string&);
 
 private:
-  std::vector <std::string> _tokens   {};
-  bool                      _additive {false};
+  std::vector <std::string> _tokens    {};
+  bool                      _additive  {false};
+  int                       _dayOfWeek {-1};
+  std::vector <Block>       _blocks    {};
 };
 
 #endif
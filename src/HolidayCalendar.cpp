@@ -0,0 +1,187 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <HolidayCalendar.h>
+#include <algorithm>
+#include <cstdio>
+#include <format.h>
+#include <timew.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Parses the 'Y_M_D' date at the end of a holiday name, without going through
+// mktime for each of them.
+static bool parseDate (const std::string& input, int& day)
+{
+  int y = 0;
+  int m = 0;
+  int d = 0;
+  int* field = &y;
+  int digits = 0;
+
+  for (auto c : input)
+  {
+    if (c >= '0' && c <= '9' && digits < 4)
+    {
+      *field = *field * 10 + (c - '0');
+      ++digits;
+    }
+    else if (c == '_' && digits > 0 && field != &d)
+    {
+      field = field == &y ? &m : &d;
+      digits = 0;
+    }
+    else
+    {
+      return false;
+    }
+  }
+
+  if (field != &d || digits == 0 || m < 1 || m > 12 || d < 1)
+    return false;
+
+  // Reject days past the end of the month, which would roll over.
+  day = daysFromCivil (y, m, d);
+
+  int year, month, dom;
+  civilFromDays (day, year, month, dom);
+  return year == y && month == m && dom == d;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static bool before (const HolidayCalendar::Holiday& left, const HolidayCalendar::Holiday& right)
+{
+  return left.day < right.day;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Holidays are named 'holidays.<locale>.<Y_M_D>'. Holidays on the same day
+// keep the order of their names.
+HolidayCalendar::HolidayCalendar (const Rules& rules)
+{
+  for (auto& name : rules.all ("holidays."))
+  {
+    auto firstDot = name.find ('.');
+    auto lastDot = name.rfind ('.');
+    if (lastDot != std::string::npos)
+    {
+      int day;
+      if (! parseDate (name.substr (lastDot + 1), day))
+        throw format ("The holiday '{1}' does not have a valid Y_M_D date.", name);
+
+      _holidays.push_back ({day,
+                            name.substr (firstDot + 1, lastDot - firstDot - 1),
+                            rules.get (name)});
+    }
+  }
+
+  std::stable_sort (_holidays.begin (), _holidays.end (), before);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool HolidayCalendar::empty () const
+{
+  return _holidays.empty ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+size_t HolidayCalendar::size () const
+{
+  return _holidays.size ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool HolidayCalendar::contains (const Datetime& datetime) const
+{
+  const Holiday key {dayOf (datetime), "", ""};
+  return std::binary_search (_holidays.begin (), _holidays.end (), key, before);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The holidays on days that overlap the range. As with Range::overlaps, a
+// range that ends at midnight does not include the following day, and a range
+// without a start includes no day at all.
+std::pair <HolidayCalendar::const_iterator, HolidayCalendar::const_iterator>
+HolidayCalendar::slice (const Range& range) const
+{
+  if (! range.is_started ())
+    return {_holidays.end (), _holidays.end ()};
+
+  const Holiday first {dayOf (range.start), "", ""};
+  auto begin = std::lower_bound (_holidays.begin (), _holidays.end (), first, before);
+
+  if (! range.is_ended ())
+    return {begin, _holidays.end ()};
+
+  auto last = dayOf (range.end);
+  if (range.end == midnight (last))
+    --last;
+
+  const Holiday key {last, "", ""};
+  return {begin, std::upper_bound (begin, _holidays.end (), key, before)};
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// One range from midnight to midnight for each day in the slice of the range
+// that has holidays.
+std::vector <Range> HolidayCalendar::ranges (const Range& range) const
+{
+  std::vector <Range> results;
+
+  auto days = slice (range);
+  for (auto holiday = days.first; holiday != days.second; ++holiday)
+    if (holiday == days.first || holiday->day != (holiday - 1)->day)
+      results.emplace_back (midnight (holiday->day), midnight (holiday->day + 1));
+
+  return results;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int HolidayCalendar::dayOf (const Datetime& datetime)
+{
+  return daysFromCivil (datetime.year (), datetime.month (), datetime.day ());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Datetime HolidayCalendar::midnight (int day)
+{
+  int y, m, d;
+  civilFromDays (day, y, m, d);
+  return Datetime (y, m, d);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The day formatted as 'Y-M-D'.
+std::string HolidayCalendar::date (int day)
+{
+  int y, m, d;
+  civilFromDays (day, y, m, d);
+
+  char buffer[16];
+  snprintf (buffer, sizeof (buffer), "%04d-%02d-%02d", y, m, d);
+  return buffer;
+}
+
+////////////////////////////////////////////////////////////////////////////////
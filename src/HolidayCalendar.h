@@ -0,0 +1,72 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_HOLIDAYCALENDAR
+#define INCLUDED_HOLIDAYCALENDAR
+
+#include <Datetime.h>
+#include <Range.h>
+#include <Rules.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+// The holidays defined in the rules, compiled once into an array that is
+// sorted by day, so that a day is found by binary search and the holidays
+// within a range are a contiguous slice of the array.
+//
+// Days are counted from 1970-01-01 in the local calendar.
+class HolidayCalendar
+{
+public:
+  struct Holiday
+  {
+    int day;
+    std::string locale;
+    std::string name;
+  };
+
+  using const_iterator = std::vector <Holiday>::const_iterator;
+
+  HolidayCalendar () = default;
+  explicit HolidayCalendar (const Rules&);
+
+  bool empty () const;
+  size_t size () const;
+
+  bool contains (const Datetime&) const;
+  std::pair <const_iterator, const_iterator> slice (const Range&) const;
+  std::vector <Range> ranges (const Range&) const;
+
+  static int dayOf (const Datetime&);
+  static Datetime midnight (int);
+  static std::string date (int);
+
+private:
+  std::vector <Holiday> _holidays {};
+};
+
+#endif
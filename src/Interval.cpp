@@ -37,7 +37,8 @@ bool Interval::operator== (const Interval& other) const
   if ((annotation == other.annotation) &&
       (_tags == other._tags) &&
       (synthetic == other.synthetic) &&
-      (id == other.id))
+      (id == other.id) &&
+      (uid == other.uid))
   {
     return Range::operator== (other);
   }
@@ -63,11 +64,31 @@ bool Interval::empty () const
 ////////////////////////////////////////////////////////////////////////////////
 bool Interval::hasTag (const std::string& tag) const
 {
-  return std::find (_tags.begin (), _tags.end (), tag) != _tags.end ();
+  auto id = TagDictionary::lookup (tag);
+  return id != TagDictionary::none &&
+         std::binary_search (_tags.begin (), _tags.end (), id);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-const std::set <std::string>& Interval::tags () const
+// Whether the interval has all of the given tags, as sorted ids.
+bool Interval::hasTags (const std::vector <unsigned int>& ids) const
+{
+  return std::includes (_tags.begin (), _tags.end (), ids.begin (), ids.end ());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The tag names, sorted by name.
+std::set <std::string> Interval::tags () const
+{
+  std::set <std::string> names;
+  for (auto id : _tags)
+    names.insert (TagDictionary::name (id));
+
+  return names;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const std::vector <unsigned int>& Interval::tagIds () const
 {
   return _tags;
 }
@@ -75,14 +96,30 @@ const std::set <std::string>& Interval::tags () const
 ////////////////////////////////////////////////////////////////////////////////
 void Interval::tag (const std::string& tag)
 {
-  if (_tags.find (tag) == _tags.end ())
-    _tags.insert (tag);
+  auto id = TagDictionary::id (tag);
+  auto position = std::lower_bound (_tags.begin (), _tags.end (), id);
+  if (position == _tags.end () || *position != id)
+    _tags.insert (position, id);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 void Interval::untag (const std::string& tag)
 {
-  _tags.erase (tag);
+  auto id = TagDictionary::lookup (tag);
+  if (id == TagDictionary::none)
+    return;
+
+  auto position = std::lower_bound (_tags.begin (), _tags.end (), id);
+  if (position != _tags.end () && *position == id)
+    _tags.erase (position);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Interval::setTagIds (std::vector <unsigned int> ids)
+{
+  std::sort (ids.begin (), ids.end ());
+  ids.erase (std::unique (ids.begin (), ids.end ()), ids.end ());
+  _tags = std::move (ids);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -99,9 +136,12 @@ std::string Interval::serialize () const
 
   if (! _tags.empty ())
   {
+    auto ids = _tags;
+    TagDictionary::sortByName (ids);
+
     out << " #";
-    for (auto& tag : _tags)
-      out << ' ' << quoteIfNeeded (tag);
+    for (auto id : ids)
+      out << ' ' << quoteIfNeeded (TagDictionary::name (id));
   }
 
   if (! annotation.empty ())
@@ -110,6 +150,9 @@ std::string Interval::serialize () const
         << " # \"" << escape (annotation, '"') << "\"";
   }
 
+  if (uid)
+    out << " ~" << formatStableId (uid);
+
   return out.str ();
 }
 
@@ -123,6 +166,11 @@ std::string Interval::json () const
   {
     out << "\"id\":" << id;
 
+    if (uid)
+    {
+      out << ",\"uid\":\"" << formatStableId (uid) << "\"";
+    }
+
     if (is_started ())
     {
       out << ",\"start\":\"" << start.toISO () << "\"";
@@ -135,13 +183,16 @@ std::string Interval::json () const
 
     if (!_tags.empty ())
     {
+      auto ids = _tags;
+      TagDictionary::sortByName (ids);
+
       std::string tags;
-      for (auto &tag : _tags)
+      for (auto id : ids)
       {
         if (tags[0])
           tags += ',';
 
-        tags += "\"" + json::encode (tag) + "\"";
+        tags += "\"" + json::encode (TagDictionary::name (id)) + "\"";
       }
 
       out << ",\"tags\":["
@@ -169,6 +220,9 @@ std::string Interval::dump () const
   if (id)
     out << " @" << id;
 
+  if (uid)
+    out << " @#" << formatStableId (uid);
+
   if (start.toEpoch ())
     out << " " << start.toISOLocalExtended ();
 
@@ -177,9 +231,12 @@ std::string Interval::dump () const
 
   if (! _tags.empty ())
   {
+    auto ids = _tags;
+    TagDictionary::sortByName (ids);
+
     out << " #";
-    for (auto& tag : _tags)
-      out << ' ' << quoteIfNeeded (tag);
+    for (auto id : ids)
+      out << ' ' << quoteIfNeeded (TagDictionary::name (id));
   }
 
   if (synthetic)
@@ -28,25 +28,31 @@
 #define INCLUDED_INTERVAL
 
 #include <Range.h>
+#include <TagDictionary.h>
+#include <cstdint>
 #include <set>
 #include <string>
 #include <utility>
+#include <vector>
 
 class Interval : public Range
 {
 public:
   Interval () = default;
   Interval (const Datetime& start, const Datetime& end) : Range (start, end) {}
-  Interval (const Range& range, std::set <std::string> tags) : Range (range), _tags(std::move(tags)) {}
+  Interval (const Range& range, const std::set <std::string>& tags) : Range (range), _tags (TagDictionary::ids (tags)) {}
 
   bool operator== (const Interval&) const;
   bool operator!= (const Interval&) const;
 
   bool empty () const;
   bool hasTag (const std::string&) const;
-  const std::set <std::string>& tags () const;
+  bool hasTags (const std::vector <unsigned int>&) const;
+  std::set <std::string> tags () const;
+  const std::vector <unsigned int>& tagIds () const;
   void tag (const std::string&);
   void untag (const std::string&);
+  void setTagIds (std::vector <unsigned int>);
 
   void setRange (const Range& range);
   void setRange (const Datetime& start, const Datetime& end);
@@ -63,8 +69,13 @@ public:
   bool                   synthetic {false};
   std::string            annotation {};
 
+  // An optional identifier that, unlike id, does not change as intervals are
+  // added. Zero if the interval has none.
+  uint64_t               uid       {0};
+
 private:
-  std::set <std::string> _tags  {};
+  // Sorted ids from the TagDictionary.
+  std::vector <unsigned int> _tags {};
 };
 
 #endif
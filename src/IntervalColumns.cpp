@@ -0,0 +1,195 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <IntervalColumns.h>
+#include <algorithm>
+#include <cassert>
+
+////////////////////////////////////////////////////////////////////////////////
+void IntervalColumns::add (const Interval& interval)
+{
+  _starts.push_back (interval.start.toEpoch ());
+  _ends.push_back (interval.end.toEpoch ());
+  _ids.push_back (interval.id);
+  _uids.push_back (interval.uid);
+  _synthetic.push_back (interval.synthetic);
+
+  auto& tags = interval.tagIds ();
+  _tags.insert (_tags.end (), tags.begin (), tags.end ());
+  _tag_offsets.push_back (_tags.size ());
+
+  _annotations += interval.annotation;
+  _annotation_offsets.push_back (_annotations.size ());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reverses the order of the intervals. Intervals are collected newest first,
+// but reported oldest first.
+void IntervalColumns::reverse ()
+{
+  std::reverse (_starts.begin (), _starts.end ());
+  std::reverse (_ends.begin (), _ends.end ());
+  std::reverse (_ids.begin (), _ids.end ());
+  std::reverse (_uids.begin (), _uids.end ());
+  std::reverse (_synthetic.begin (), _synthetic.end ());
+
+  // The variable length columns are rebuilt back to front.
+  std::vector <uint32_t> tag_offsets {0};
+  std::vector <unsigned int> tags;
+  std::vector <uint32_t> annotation_offsets {0};
+  std::string annotations;
+
+  tag_offsets.reserve (_tag_offsets.size ());
+  tags.reserve (_tags.size ());
+  annotation_offsets.reserve (_annotation_offsets.size ());
+  annotations.reserve (_annotations.size ());
+
+  for (auto i = _starts.size (); i > 0; --i)
+  {
+    tags.insert (tags.end (), _tags.begin () + _tag_offsets[i - 1], _tags.begin () + _tag_offsets[i]);
+    tag_offsets.push_back (tags.size ());
+
+    annotations.append (_annotations, _annotation_offsets[i - 1], _annotation_offsets[i] - _annotation_offsets[i - 1]);
+    annotation_offsets.push_back (annotations.size ());
+  }
+
+  _tag_offsets.swap (tag_offsets);
+  _tags.swap (tags);
+  _annotation_offsets.swap (annotation_offsets);
+  _annotations.swap (annotations);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+size_t IntervalColumns::size () const
+{
+  return _starts.size ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool IntervalColumns::empty () const
+{
+  return _starts.empty ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int64_t IntervalColumns::start (size_t index) const
+{
+  return _starts[index];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Zero for an open interval.
+int64_t IntervalColumns::end (size_t index) const
+{
+  return _ends[index];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int IntervalColumns::id (size_t index) const
+{
+  return _ids[index];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+uint64_t IntervalColumns::uid (size_t index) const
+{
+  return _uids[index];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool IntervalColumns::synthetic (size_t index) const
+{
+  return _synthetic[index];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+IntervalColumns::TagIds IntervalColumns::tagIds (size_t index) const
+{
+  auto base = _tags.data ();
+  return {base + _tag_offsets[index], base + _tag_offsets[index + 1]};
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string_view IntervalColumns::annotation (size_t index) const
+{
+  return std::string_view (_annotations).substr (
+    _annotation_offsets[index],
+    _annotation_offsets[index + 1] - _annotation_offsets[index]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Same as range.overlaps (interval (index)), see Range::overlaps.
+bool IntervalColumns::overlaps (size_t index, const Range& range) const
+{
+  auto start = _starts[index];
+  auto end = _ends[index];
+
+  if (! range.is_started () || start <= 0)
+  {
+    return false;
+  }
+
+  if (end > 0 && end <= range.start.toEpoch ())
+  {
+    return false;
+  }
+
+  if (range.is_ended () && start >= range.end.toEpoch ())
+  {
+    return false;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Same as range.intersects (interval (index)), see Range::intersects.
+bool IntervalColumns::intersects (size_t index, const Range& range) const
+{
+  return overlaps (index, range) ||
+         (range.is_started () && _starts[index] > 0 && _starts[index] == range.start.toEpoch ());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Interval IntervalColumns::interval (size_t index) const
+{
+  assert (index < size ());
+
+  Interval interval;
+  interval.start = Datetime (_starts[index]);
+  interval.end = Datetime (_ends[index]);
+  interval.id = _ids[index];
+  interval.uid = _uids[index];
+  interval.synthetic = _synthetic[index];
+  interval.annotation = std::string (annotation (index));
+
+  auto tags = tagIds (index);
+  interval.setTagIds (std::vector <unsigned int> (tags.begin (), tags.end ()));
+
+  return interval;
+}
+
+////////////////////////////////////////////////////////////////////////////////
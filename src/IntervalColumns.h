@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_INTERVALCOLUMNS
+#define INCLUDED_INTERVALCOLUMNS
+
+#include <Interval.h>
+#include <Range.h>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A compact, column-wise store of intervals for reports. Instead of one
+// Interval object each, intervals are held in parallel arrays of epochs, ids,
+// tag ids and annotations, which keeps scans over many intervals cheap. Single
+// intervals are only materialized for output.
+class IntervalColumns
+{
+public:
+  // The tag ids of one interval, as a view into the column.
+  struct TagIds
+  {
+    const unsigned int* first;
+    const unsigned int* last;
+
+    const unsigned int* begin () const { return first; }
+    const unsigned int* end () const { return last; }
+    size_t size () const { return last - first; }
+    bool empty () const { return first == last; }
+  };
+
+  IntervalColumns () = default;
+
+  void add (const Interval&);
+  void reverse ();
+
+  size_t size () const;
+  bool empty () const;
+
+  int64_t start (size_t) const;
+  int64_t end (size_t) const;
+  int id (size_t) const;
+  uint64_t uid (size_t) const;
+  bool synthetic (size_t) const;
+  TagIds tagIds (size_t) const;
+  std::string_view annotation (size_t) const;
+
+  bool overlaps (size_t, const Range&) const;
+  bool intersects (size_t, const Range&) const;
+  Interval interval (size_t) const;
+
+private:
+  std::vector <int64_t>      _starts              {};
+  std::vector <int64_t>      _ends                {};
+  std::vector <int>          _ids                 {};
+  std::vector <uint64_t>     _uids                {};
+  std::vector <bool>         _synthetic           {};
+
+  // The tags and annotation of interval i are at [offsets[i], offsets[i + 1]).
+  std::vector <uint32_t>     _tag_offsets         {0};
+  std::vector <unsigned int> _tags                {};
+  std::vector <uint32_t>     _annotation_offsets  {0};
+  std::string                _annotations         {};
+};
+
+#endif
@@ -0,0 +1,147 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <IntervalExpansion.h>
+#include <RangeSet.h>
+#include <timew.h>
+
+////////////////////////////////////////////////////////////////////////////////
+IntervalExpansion::IntervalExpansion (const Interval& latest, const Rules& rules)
+: _latest (latest)
+, _rules (rules)
+, _from (_now)
+, _complete (! latest.is_open ())
+, _rest (latest)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Only once a second range is found is the latest interval known to be split.
+// Until then, the first range is held back.
+bool IntervalExpansion::next (Interval& interval)
+{
+  if (_id == 0)
+  {
+    ++_id;
+    interval = _latest;
+    interval.id = _id;
+
+    Range first;
+    if (! _latest.is_open () ||
+        ! nextRange (first) ||
+        ! nextRange (_lookahead))
+    {
+      _exhausted = true;
+      return true;
+    }
+
+    _hasLookahead = true;
+    interval.setRange (first);
+    interval.synthetic = true;
+    return true;
+  }
+
+  if (! _hasLookahead)
+  {
+    return false;
+  }
+
+  interval = _latest;
+  interval.setRange (_lookahead);
+  interval.synthetic = true;
+  interval.id = ++_id;
+
+  _hasLookahead = nextRange (_lookahead);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Yields the ranges that flatten would give for the latest interval, newest
+// first. An exclusion is only final once it starts within the known window,
+// since an older exclusion may yet be combined with it.
+bool IntervalExpansion::nextRange (Range& range)
+{
+  while (! _exhausted)
+  {
+    if (! _exclusions.empty () &&
+        (_complete || _exclusions.back ().start >= _from))
+    {
+      auto exclusion = _exclusions.back ();
+      _exclusions.pop_back ();
+
+      if (! _latest.encloses (exclusion))
+      {
+        continue;
+      }
+
+      range = Range (exclusion.end, _rest.end);
+      _rest.end = exclusion.start;
+
+      if (range.start > _now || range.is_empty ())
+      {
+        continue;
+      }
+
+      return true;
+    }
+
+    if (! _complete)
+    {
+      extend ();
+      continue;
+    }
+
+    _exhausted = true;
+    if (_rest.start <= _now && ! _rest.is_empty ())
+    {
+      range = _rest;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Looks up the exclusions in the next window, which reaches back from where
+// the last one started, and combines them with those not yet consumed.
+void IntervalExpansion::extend ()
+{
+  Datetime from (_from.toEpoch () - _span);
+  if (from <= _latest.start)
+  {
+    from = _latest.start;
+    _complete = true;
+  }
+
+  _span *= 2;
+
+  auto found = getAllExclusions (_rules, {from, _from});
+  _exclusions = RangeSet (_exclusions).unite (RangeSet (found)).ranges ();
+  _from = from;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_INTERVALEXPANSION
+#define INCLUDED_INTERVALEXPANSION
+
+#include <Datetime.h>
+#include <Interval.h>
+#include <Range.h>
+#include <Rules.h>
+#include <ctime>
+#include <vector>
+
+// Expands the latest interval, while it is open, into the synthetic intervals
+// that lie between the exclusions since it started. They are yielded newest
+// first, with ids from 1. An interval that is not split is yielded unchanged.
+//
+// The exclusions are looked up on demand, in windows that reach back from now
+// and double in size, so a caller that stops after the newest few intervals
+// does not pay for the exclusions of all the days the interval has been open.
+class IntervalExpansion
+{
+public:
+  IntervalExpansion (const Interval&, const Rules&);
+  bool next (Interval&);
+
+private:
+  bool nextRange (Range&);
+  void extend ();
+
+private:
+  const Interval      _latest;
+  const Rules&        _rules;
+  const Datetime      _now          {};
+  Datetime            _from         {};
+  time_t              _span         {86400};
+  bool                _complete     {false};
+  std::vector <Range> _exclusions   {};
+  Range               _rest         {};
+  bool                _exhausted    {false};
+  Range               _lookahead    {};
+  bool                _hasLookahead {false};
+  int                 _id           {0};
+};
+
+#endif
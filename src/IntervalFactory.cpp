@@ -27,7 +27,9 @@
 #include <IntervalFactory.h>
 #include <JSON.h>
 #include <Lexer.h>
+#include <array>
 #include <format.h>
+#include <timew.h>
 
 static std::vector <std::string> tokenizeSerialization (const std::string& line) 
 {
@@ -56,13 +58,124 @@ static std::vector <std::string> tokenizeSerialization (const std::string& line)
   return tokens;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// The tokens of one line, held without allocating.  A line with more tokens
+// than fit is left to the Lexer.
+class SerializationTokens
+{
+public:
+  bool push_back (std::string_view token)
+  {
+    if (_size == _tokens.size ())
+      return false;
+
+    _tokens[_size++] = token;
+    return true;
+  }
+
+  bool empty () const                                 { return _size == 0; }
+  size_t size () const                                { return _size; }
+  std::string_view operator[] (size_t index) const    { return _tokens[index]; }
+
+private:
+  std::array <std::string_view, 64> _tokens {};
+  size_t _size {0};
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Splits a serialization on single spaces without going through the Lexer.
+// Only the two token shapes Interval::serialize writes for plain data are
+// handled here:
+//
+//   - a word of ASCII letters and digits, or a lone '-' or '#', and
+//   - a double-quoted string of printable ASCII without '\\' or 'U+'.
+//
+// For these, the tokens are exactly those the Lexer would produce after
+// dequoting.  Anything else (escapes, other punctuation, non-ASCII text,
+// tabs) returns false, and the line is left to the Lexer.
+static bool splitSerialization (std::string_view line, SerializationTokens& tokens)
+{
+  const auto length = line.length ();
+  std::string::size_type i = 0;
+
+  while (i < length)
+  {
+    if (line[i] == ' ')
+    {
+      ++i;
+      continue;
+    }
+
+    auto start = i;
+    if (line[i] == '"')
+    {
+      ++i;
+      while (i < length && line[i] != '"')
+      {
+        auto c = line[i];
+        if (c < 0x20 || c > 0x7e || c == '\\' ||
+            (c == 'U' && i + 1 < length && line[i + 1] == '+'))
+          return false;
+
+        ++i;
+      }
+
+      // Unterminated, or followed by something other than a separator.
+      if (i == length || (i + 1 < length && line[i + 1] != ' '))
+        return false;
+
+      if (! tokens.push_back (line.substr (start + 1, i - start - 1)))
+        return false;
+
+      ++i;
+    }
+    else if ((line[i] == '-' || line[i] == '#') &&
+             (i + 1 == length || line[i + 1] == ' '))
+    {
+      if (! tokens.push_back (line.substr (i++, 1)))
+        return false;
+    }
+    else
+    {
+      while (i < length && line[i] != ' ')
+      {
+        auto c = line[i];
+        if (! ((c >= 'a' && c <= 'z') ||
+               (c >= 'A' && c <= 'Z') ||
+               (c >= '0' && c <= '9')))
+          return false;
+
+        ++i;
+      }
+
+      if (! tokens.push_back (line.substr (start, i - start)))
+        return false;
+    }
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Serializations hold UTC timestamps of a fixed form, which are decoded
+// directly.  Any other form goes through Datetime, as it always did.
+static Datetime parseTimestamp (std::string_view token)
+{
+  time_t epoch;
+  if (parseUtcTimestamp (token, epoch))
+    return Datetime (epoch);
+
+  return Datetime (std::string (token));
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Syntax:
 //   'inc' [ <iso> [ '-' <iso> ]] [ '#' <tag> [ <tag> ... ]]
-Interval IntervalFactory::fromSerialization (const std::string& line)
+//
+// Shared by both tokenizers, so that the grammar is only written down once.
+template <typename Tokens>
+static Interval parseSerialization (std::string_view line, const Tokens& tokens)
 {
-  std::vector <std::string> tokens = tokenizeSerialization (line);
-
   // Minimal requirement 'inc'.
   if (!tokens.empty () && tokens[0] == "inc")
   {
@@ -74,7 +187,7 @@ Interval IntervalFactory::fromSerialization (const std::string& line)
     if (tokens.size () > 1 &&
         tokens[1].length () == 16)
     {
-      interval.start = Datetime (tokens[1]);
+      interval.start = parseTimestamp (tokens[1]);
       offset = 1;
 
       // Optional '-' <iso>
@@ -82,7 +195,7 @@ Interval IntervalFactory::fromSerialization (const std::string& line)
           tokens[2] == "-"   &&
           tokens[3].length () == 16)
       {
-        interval.end = Datetime (tokens[3]);
+        interval.end = parseTimestamp (tokens[3]);
         offset = 3;
       }
     }
@@ -95,7 +208,7 @@ Interval IntervalFactory::fromSerialization (const std::string& line)
 
       while (index < tokens.size () && tokens[index] != "#")
       {
-        interval.tag (tokens[index]);
+        interval.tag (std::string (tokens[index]));
         index++;
       }
 
@@ -107,7 +220,10 @@ Interval IntervalFactory::fromSerialization (const std::string& line)
         // Optional <annotation> ...
         for (unsigned int i = index + 1; i < tokens.size (); ++i)
         {
-          annotation += (i > index +1 ? " " : "") + tokens[i];
+          if (i > index + 1)
+            annotation += ' ';
+
+          annotation += tokens[i];
         }
 
         interval.setAnnotation (annotation);
@@ -117,42 +233,150 @@ Interval IntervalFactory::fromSerialization (const std::string& line)
     return interval;
   }
 
-  throw format ("Unrecognizable line '{1}'.", line);
+  throw format ("Unrecognizable line '{1}'.", std::string (line));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-Interval IntervalFactory::fromJson (const std::string& jsonString)
+// A stable id follows the rest of a serialization as ' ~<16 hex digits>'.
+// Neither a tag nor an annotation can end a line like this, since both are
+// quoted when they contain a '~'. Returns the line without the id.
+static std::string_view splitStableId (std::string_view line, uint64_t& uid)
+{
+  uid = 0;
+
+  if (line.size () > 18 &&
+      line[line.size () - 18] == ' ' &&
+      line[line.size () - 17] == '~')
+  {
+    uid = parseStableId (line.substr (line.size () - 16));
+    if (uid)
+      return line.substr (0, line.size () - 18);
+  }
+
+  return line;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Interval IntervalFactory::fromSerialization (std::string_view line)
+{
+  Interval interval;
+  if (fromSerializationFast (line, interval))
+    return interval;
+
+  return fromSerializationLexer (line);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Parses the line without the Lexer.  Returns false, leaving the interval
+// untouched, when the line contains anything splitSerialization does not
+// handle.
+bool IntervalFactory::fromSerializationFast (std::string_view line, Interval& interval)
+{
+  uint64_t uid;
+  auto rest = splitStableId (line, uid);
+
+  SerializationTokens tokens;
+  if (! splitSerialization (rest, tokens))
+    return false;
+
+  interval = parseSerialization (line, tokens);
+  interval.uid = uid;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Interval IntervalFactory::fromSerializationLexer (std::string_view line)
+{
+  uint64_t uid;
+  auto rest = splitStableId (line, uid);
+
+  auto interval = parseSerialization (line, tokenizeSerialization (std::string (rest)));
+  interval.uid = uid;
+  return interval;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Takes only the stable id from a serialization, without parsing the rest.
+uint64_t IntervalFactory::stableId (std::string_view line)
+{
+  uint64_t uid;
+  splitStableId (line, uid);
+  return uid;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static Interval fromJsonObject (json::object* json)
 {
   Interval interval = Interval ();
 
+  json::array* tags = (json::array*) json->_data["tags"];
+
+  if (tags != nullptr)
+  {
+    for (auto& tag : tags->_data)
+    {
+      auto* value = (json::string*) tag;
+      interval.tag (json::decode (value->_data));
+    }
+  }
+
+  json::string* annotation = (json::string*) json->_data["annotation"];
+  interval.annotation = (annotation != nullptr) ? json::decode (annotation->_data) : "";
+
+  json::string* start = (json::string*) json->_data["start"];
+  interval.start = (start != nullptr) ? Datetime(start->_data) : 0;
+  json::string* end = (json::string*) json->_data["end"];
+  interval.end = (end != nullptr) ? Datetime(end->_data) : 0;
+
+  json::number* id = (json::number*) json->_data["id"];
+  interval.id = (id != nullptr) ? id->_dvalue : 0;
+
+  json::string* uid = (json::string*) json->_data["uid"];
+  interval.uid = (uid != nullptr) ? parseStableId (uid->_data) : 0;
+
+  return interval;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Interval IntervalFactory::fromJson (const std::string& jsonString)
+{
   if (!jsonString.empty ())
   {
     std::unique_ptr <json::object> json (dynamic_cast <json::object *> (json::parse (jsonString)));
+    return fromJsonObject (json.get ());
+  }
+
+  return Interval ();
+}
 
-    json::array* tags = (json::array*) json->_data["tags"];
+////////////////////////////////////////////////////////////////////////////////
+// Parses a JSON array of intervals, as recorded for a Database::WriteBatch.
+std::vector <Interval> IntervalFactory::fromJsonArray (const std::string& jsonString)
+{
+  std::vector <Interval> intervals;
 
-    if (tags != nullptr)
+  if (!jsonString.empty ())
+  {
+    std::unique_ptr <json::value> json (json::parse (jsonString));
+    auto* array = dynamic_cast <json::array *> (json.get ());
+    if (array == nullptr)
     {
-      for (auto& tag : tags->_data)
-      {
-        auto* value = (json::string*) tag;
-        interval.tag (json::decode (value->_data));
-      }
+      throw format ("Invalid interval list '{1}'", jsonString);
     }
 
-    json::string* annotation = (json::string*) json->_data["annotation"];
-    interval.annotation = (annotation != nullptr) ? json::decode (annotation->_data) : "";
-
-    json::string* start = (json::string*) json->_data["start"];
-    interval.start = (start != nullptr) ? Datetime(start->_data) : 0;
-    json::string* end = (json::string*) json->_data["end"];
-    interval.end = (end != nullptr) ? Datetime(end->_data) : 0;
+    for (auto& element : array->_data)
+    {
+      auto* object = dynamic_cast <json::object *> (element);
+      if (object == nullptr)
+      {
+        throw format ("Invalid interval list '{1}'", jsonString);
+      }
 
-    json::number* id = (json::number*) json->_data["id"];
-    interval.id = (id != nullptr) ? id->_dvalue : 0;
+      intervals.push_back (fromJsonObject (object));
+    }
   }
 
-  return interval;
+  return intervals;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -28,13 +28,22 @@
 #define INCLUDED_INTERVALFACTORY
 
 #include <Interval.h>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <vector>
 
 class IntervalFactory
 {
 public:
-  static Interval fromSerialization (const std::string& line);
+  static Interval fromSerialization (std::string_view line);
   static Interval fromJson (const std::string& jsonString);
+  static std::vector <Interval> fromJsonArray (const std::string& jsonString);
+  static uint64_t stableId (std::string_view line);
+
+  // The two parsers behind fromSerialization, exposed for testing.
+  static bool fromSerializationFast (std::string_view line, Interval&);
+  static Interval fromSerializationLexer (std::string_view line);
 };
 
 #endif
@@ -41,3 +41,17 @@ void IntervalFilter::reset ()
 {
   set_done (false);
 }
+
+// Every accepted interval intersects this range. Filters that do not look at
+// time at all leave it unbounded.
+Range IntervalFilter::range () const
+{
+  return {};
+}
+
+// No interval with a lower id than this is accepted any more, so intervals
+// before it need not be read. Filters that do not look at ids return 0.
+int IntervalFilter::next_id () const
+{
+  return 0;
+}
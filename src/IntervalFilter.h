@@ -34,6 +34,8 @@ class IntervalFilter
 public:
   virtual bool accepts (const Interval&) = 0;
   virtual void reset ();
+  virtual Range range () const;
+  virtual int next_id () const;
   virtual ~IntervalFilter() = default;
 
   bool is_done () const;
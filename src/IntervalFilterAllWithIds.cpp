@@ -56,3 +56,8 @@ void IntervalFilterAllWithIds::reset ()
   set_done (false);
   _id_it = _ids.begin ();
 }
+
+int IntervalFilterAllWithIds::next_id () const
+{
+  return (_id_it != _id_end) ? *_id_it : 0;
+}
@@ -39,6 +39,7 @@ public:
 
   bool accepts (const Interval&) final;
   void reset () override;
+  int next_id () const override;
 
 private:
   const std::set <int> _ids {};
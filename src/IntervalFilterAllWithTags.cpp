@@ -26,19 +26,12 @@
 
 #include <Interval.h>
 #include <IntervalFilterAllWithTags.h>
+#include <TagDictionary.h>
 
-IntervalFilterAllWithTags::IntervalFilterAllWithTags (std::set <std::string> tags): _tags (std::move(tags))
+IntervalFilterAllWithTags::IntervalFilterAllWithTags (std::set <std::string> tags): _tags (TagDictionary::ids (tags))
 {}
 
 bool IntervalFilterAllWithTags::accepts (const Interval& interval)
 {
-  for (auto& tag : _tags)
-  {
-    if (! interval.hasTag (tag))
-    {
-      return false;
-    }
-  }
-
-  return true;
+  return interval.hasTags (_tags);
 }
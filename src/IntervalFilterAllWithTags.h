@@ -31,6 +31,7 @@
 #include <IntervalFilter.h>
 #include <set>
 #include <string>
+#include <vector>
 
 class IntervalFilterAllWithTags : public IntervalFilter
 {
@@ -40,7 +41,7 @@ public:
   bool accepts (const Interval&) final;
 
 private:
-  const std::set <std::string> _tags {};
+  const std::vector <unsigned int> _tags {};
 };
 
 #endif //INCLUDED_INTERVALFILTERTAGSET
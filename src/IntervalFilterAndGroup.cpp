@@ -25,6 +25,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <IntervalFilterAndGroup.h>
+#include <algorithm>
 
 IntervalFilterAndGroup::IntervalFilterAndGroup (std::vector <std::shared_ptr<IntervalFilter>> filters) : _filters (std::move(filters))
 {}
@@ -61,3 +62,41 @@ void IntervalFilterAndGroup::reset ()
     filter->reset ();
   }
 }
+
+// An accepted interval has to satisfy all filters, so the ranges of the
+// filters narrow each other down.
+Range IntervalFilterAndGroup::range () const
+{
+  Range result;
+
+  for (auto& filter: _filters)
+  {
+    auto range = filter->range ();
+
+    if (range.is_started () && (! result.is_started () || result.start < range.start))
+    {
+      result.start = range.start;
+    }
+
+    if (range.is_ended () && (! result.is_ended () || range.end < result.end))
+    {
+      result.end = range.end;
+    }
+  }
+
+  return result;
+}
+
+// An accepted interval has to satisfy all filters, so it cannot come before
+// the next id any of them accepts.
+int IntervalFilterAndGroup::next_id () const
+{
+  int result = 0;
+
+  for (auto& filter: _filters)
+  {
+    result = std::max (result, filter->next_id ());
+  }
+
+  return result;
+}
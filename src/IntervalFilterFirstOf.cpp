@@ -47,3 +47,13 @@ void IntervalFilterFirstOf::reset ()
   set_done (false);
   _filter->reset ();
 }
+
+Range IntervalFilterFirstOf::range () const
+{
+  return _filter->range ();
+}
+
+int IntervalFilterFirstOf::next_id () const
+{
+  return _filter->next_id ();
+}
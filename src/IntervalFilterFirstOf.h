@@ -36,7 +36,9 @@ public:
   explicit IntervalFilterFirstOf(std::shared_ptr <IntervalFilter> filter);
 
   bool accepts (const Interval&) final;
-  void reset ();
+  void reset () override;
+  Range range () const override;
+  int next_id () const override;
 
 private:
   std::shared_ptr <IntervalFilter> _filter;
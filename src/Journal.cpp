@@ -27,32 +27,41 @@
 #include <AtomicFile.h>
 #include <Journal.h>
 #include <TransactionsFactory.h>
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <format.h>
 #include <timew.h>
 
-////////////////////////////////////////////////////////////////////////////////
+static const char     JOURNAL_INDEX_MAGIC[4]  = {'T', 'W', 'J', 'X'};
+static const uint32_t JOURNAL_INDEX_VERSION   = 1;
+static const uint32_t JOURNAL_INDEX_BYTEORDER = 0x01020304;
 
-bool Journal::enabled () const
+// The trailer ends the index, after the offsets of all transactions, so that
+// appending or dropping a transaction only rewrites the end of the index.
+struct JournalIndexTrailer
 {
-  return _size != 0;
-}
+  uint64_t data_size;
+  uint32_t head;
+  uint32_t version;
+  uint32_t byteorder;
+  char     magic[4];
+};
 
-////////////////////////////////////////////////////////////////////////////////
+static_assert (sizeof (JournalIndexTrailer) == 24, "JournalIndexTrailer must not be padded");
 
-std::vector<Transaction> loadJournal (AtomicFile& undo)
+////////////////////////////////////////////////////////////////////////////////
+static std::string indexLocation (const std::string& location)
 {
-  std::vector <std::string> read_lines;
-  undo.read (read_lines);
-  undo.close ();
-
-  TransactionsFactory transactionsFactory;
+  auto dot = location.rfind (".data");
+  return (dot == std::string::npos ? location : location.substr (0, dot)) + ".idx";
+}
 
-  for (auto& line: read_lines)
-  {
-    transactionsFactory.parseLine (line);
-  }
+////////////////////////////////////////////////////////////////////////////////
 
-  return transactionsFactory.get ();
+bool Journal::enabled () const
+{
+  return _size != 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -68,6 +77,12 @@ void Journal::initialize (const std::string& location, int size)
     {
       undo.remove ();
     }
+
+    AtomicFile index (indexLocation (_location));
+    if (index.exists ())
+    {
+      index.remove ();
+    }
   }
 }
 
@@ -86,6 +101,10 @@ void Journal::startTransaction ()
 }
 
 ////////////////////////////////////////////////////////////////////////////////
+// With journal.size set, the oldest transactions are only marked as trimmed.
+// They are dropped from the log once they outnumber the ones that are left,
+// which copies fewer than journal.size transactions after at least as many
+// were appended, so that trimming takes amortized constant time.
 void Journal::endTransaction ()
 {
   if (!enabled ())
@@ -99,33 +118,23 @@ void Journal::endTransaction ()
     throw "Call to end non-existent transaction";
   }
 
-  AtomicFile undo (_location);
+  load ();
 
-  if (_size > 1)
+  auto live = _offsets.size () - _head;
+  if (_size > 0 && live >= static_cast <size_t> (_size))
   {
-    std::vector <Transaction> transactions = loadJournal (undo);
-
-    unsigned int toCopy = _size - 1;
-    auto it = transactions.cbegin ();
-    auto end = transactions.cend ();
-
-    if (transactions.size () > toCopy)
-    {
-      it += transactions.size () - toCopy;
-    }
-
-    undo.truncate ();
-    for (; it != end; ++it)
-    {
-      undo.append (it->toString ());
-    }
+    _head += live - (_size - 1);
   }
-  else if (_size == 1)
+
+  if (_head > 0 && _head >= _offsets.size () - _head)
   {
-    undo.truncate ();
+    compact ();
   }
 
-  undo.append (_currentTransaction->toString ());
+  _offsets.push_back (_data->size ());
+  _data->append (_currentTransaction->toString ());
+  saveIndex ();
+
   _currentTransaction.reset ();
 }
 
@@ -141,9 +150,18 @@ void Journal::recordIntervalAction (const std::string&  before, const std::strin
   recordUndoAction ("interval", before, after);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Records the changes of a Database::WriteBatch, as JSON arrays of the deleted
+// and the added intervals.
+void Journal::recordIntervalsAction (const std::string& before, const std::string& after)
+{
+  recordUndoAction ("intervals", before, after);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Record undoable actions. There are several types:
 //   interval    changes to stored intervals
+//   intervals   changes to many stored intervals at once
 //   config      changes to configuration
 //
 // Actions are only recorded if a transaction is open
@@ -160,6 +178,7 @@ void Journal::recordUndoAction (
 }
 
 ////////////////////////////////////////////////////////////////////////////////
+// Only the last transaction is read, and then truncated away.
 Transaction Journal::popLastTransaction ()
 {
   if (! enabled ())
@@ -167,34 +186,193 @@ Transaction Journal::popLastTransaction ()
     return Transaction {};
   }
 
-  AtomicFile undo (_location);
-  std::vector <Transaction> transactions = loadJournal (undo);
+  load ();
 
-  if (transactions.empty ())
+  if (_offsets.size () == _head)
   {
     return Transaction {};
   }
 
-  Transaction last = transactions.back ();
-  transactions.pop_back ();
+  auto start = _offsets.back ();
+  auto content = _data->read (start, _data->size () - start);
+
+  TransactionsFactory transactionsFactory;
 
-  if (transactions.empty ())
+  std::string::size_type line = 0;
+  while (line < content.size ())
   {
-    undo.close ();
-    undo.remove ();
+    auto eol = content.find ('\n', line);
+    if (eol == std::string::npos)
+    {
+      eol = content.size ();
+    }
+
+    transactionsFactory.parseLine (content.substr (line, eol - line));
+    line = eol + 1;
+  }
+
+  _offsets.pop_back ();
+
+  if (_offsets.size () == _head)
+  {
+    _data->remove ();
+    _index->remove ();
+    _offsets.clear ();
+    _head = 0;
+    _saved = 0;
   }
   else
   {
-    undo.open ();
-    undo.truncate ();
+    _data->truncate (start);
+    saveIndex ();
+  }
+
+  auto transactions = transactionsFactory.get ();
+  return transactions.empty () ? Transaction {} : transactions.back ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Journal::load ()
+{
+  if (_data != nullptr)
+  {
+    return;
+  }
+
+  _data = std::make_unique <LogFile> (_location);
+  _index = std::make_unique <LogFile> (indexLocation (_location));
+
+  if (! loadIndex ())
+  {
+    rebuildIndex ();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The index is only trusted if it describes a log of the current size, and
+// its last offset points at the start of a transaction.
+bool Journal::loadIndex ()
+{
+  const auto size = _index->size ();
+  if (size < sizeof (JournalIndexTrailer) ||
+      (size - sizeof (JournalIndexTrailer)) % sizeof (uint64_t) != 0)
+  {
+    return false;
+  }
+
+  const auto content = _index->read (0, size);
+
+  JournalIndexTrailer trailer;
+  std::memcpy (&trailer, content.data () + size - sizeof (JournalIndexTrailer), sizeof (JournalIndexTrailer));
+
+  const auto count = (size - sizeof (JournalIndexTrailer)) / sizeof (uint64_t);
+  if (std::memcmp (trailer.magic, JOURNAL_INDEX_MAGIC, 4) != 0 ||
+      trailer.version   != JOURNAL_INDEX_VERSION                ||
+      trailer.byteorder != JOURNAL_INDEX_BYTEORDER              ||
+      trailer.data_size != _data->size ()                       ||
+      trailer.head      >  count)
+  {
+    return false;
+  }
 
-    for (auto& transaction : transactions)
+  _offsets.resize (count);
+  std::memcpy (_offsets.data (), content.data (), count * sizeof (uint64_t));
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (_offsets[i] >= trailer.data_size ||
+        (i > 0 && _offsets[i] <= _offsets[i - 1]))
     {
-      undo.append (transaction.toString ());
+      _offsets.clear ();
+      return false;
     }
+  }
+
+  if (count > 0 && _data->read (_offsets.back (), 5) != "txn:\n")
+  {
+    _offsets.clear ();
+    return false;
+  }
+
+  _head = trailer.head;
+  _saved = count;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Journals written without an index, or with a stale one, are scanned once
+// for the start of every transaction.
+void Journal::rebuildIndex ()
+{
+  if (_index->exists ())
+  {
+    debug (format ("{1}: Index is stale", indexLocation (_location)));
+  }
 
-    undo.close ();
+  const auto content = _data->read (0, _data->size ());
+
+  _offsets.clear ();
+
+  std::string::size_type line = 0;
+  while (line < content.size ())
+  {
+    if (content.compare (line, 5, "txn:\n") == 0)
+    {
+      _offsets.push_back (line);
+    }
+
+    auto eol = content.find ('\n', line);
+    if (eol == std::string::npos)
+    {
+      break;
+    }
+
+    line = eol + 1;
+  }
+
+  _head = 0;
+  _saved = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Rewrites the index from the first offset that changed since it was loaded
+// or last saved.
+void Journal::saveIndex ()
+{
+  _saved = std::min (_saved, _offsets.size ());
+
+  JournalIndexTrailer trailer {};
+  trailer.data_size = _data->size ();
+  trailer.head      = static_cast <uint32_t> (_head);
+  trailer.version   = JOURNAL_INDEX_VERSION;
+  trailer.byteorder = JOURNAL_INDEX_BYTEORDER;
+  std::memcpy (trailer.magic, JOURNAL_INDEX_MAGIC, 4);
+
+  std::string out;
+  out.append (reinterpret_cast <const char*> (_offsets.data () + _saved), (_offsets.size () - _saved) * sizeof (uint64_t));
+  out.append (reinterpret_cast <const char*> (&trailer), sizeof (trailer));
+
+  _index->truncate (std::min (_index->size (), _saved * sizeof (uint64_t)));
+  _index->append (out);
+  _saved = _offsets.size ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Drops the trimmed transactions from the start of the log.
+void Journal::compact ()
+{
+  const auto start = _head < _offsets.size () ? _offsets[_head] : _data->size ();
+  const auto content = _data->read (start, _data->size () - start);
+
+  _data->truncate (0);
+  _data->append (content);
+
+  _offsets.erase (_offsets.begin (), _offsets.begin () + _head);
+  for (auto& offset : _offsets)
+  {
+    offset -= start;
   }
 
-  return last;
+  _head = 0;
+  _saved = 0;
 }
@@ -28,7 +28,9 @@
 #define INCLUDED_JOURNAL
 
 
+#include <LogFile.h>
 #include <Transaction.h>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -46,6 +48,7 @@ public:
   void endTransaction ();
   void recordConfigAction(const std::string&, const std::string&);
   void recordIntervalAction(const std::string&, const std::string&);
+  void recordIntervalsAction(const std::string&, const std::string&);
   bool enabled () const;
 
   Transaction popLastTransaction();
@@ -53,9 +56,25 @@ public:
 private:
   void recordUndoAction (const std::string &, const std::string &, const std::string &);
 
+  void load ();
+  bool loadIndex ();
+  void rebuildIndex ();
+  void saveIndex ();
+  void compact ();
+
   std::string _location {};
   std::shared_ptr <Transaction> _currentTransaction = nullptr;
   int _size {0};
+
+  // The journal is an append-only log of transactions, with a sidecar index
+  // (undo.idx) holding the offset of every transaction in the log. The first
+  // _head transactions have been trimmed by journal.size, and are dropped
+  // from the log once they outnumber the remaining ones.
+  std::unique_ptr <LogFile> _data {};
+  std::unique_ptr <LogFile> _index {};
+  std::vector <uint64_t> _offsets {};
+  size_t _head {0};
+  size_t _saved {0};
 };
 
 #endif
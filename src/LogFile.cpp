@@ -0,0 +1,138 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <LogFile.h>
+#include <algorithm>
+#include <cassert>
+#include <format.h>
+#include <fstream>
+
+////////////////////////////////////////////////////////////////////////////////
+// An update interrupted by a previous command is rolled back first.
+LogFile::LogFile (const Path& path)
+: _path (path)
+, _file (path)
+{
+  AtomicFile::recover (_path);
+
+  File file (_path);
+  _exists = file.exists ();
+  _offset = _exists ? file.size () : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool LogFile::exists () const
+{
+  return _exists || ! _tail.empty ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+size_t LogFile::size () const
+{
+  return _offset + _tail.size ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reads from the file what is still unchanged, and the rest from memory.
+std::string LogFile::read (size_t offset, size_t length) const
+{
+  assert (offset + length <= size ());
+
+  std::string content (length, '\0');
+  size_t from_file = offset < _offset ? std::min (length, _offset - offset) : 0;
+
+  if (from_file > 0)
+  {
+    std::ifstream in (_path._data, std::ios::in | std::ios::binary);
+    in.seekg (offset);
+    in.read (&content[0], from_file);
+    if (! in.good ())
+    {
+      throw format ("Unable to read '{1}'.", _path._data);
+    }
+  }
+
+  if (from_file < length)
+  {
+    _tail.copy (&content[from_file], length - from_file, offset + from_file - _offset);
+  }
+
+  return content;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void LogFile::append (const std::string& content)
+{
+  _tail += content;
+  update ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void LogFile::truncate (size_t length)
+{
+  assert (length <= size ());
+
+  if (length < _offset)
+  {
+    _offset = length;
+    _tail.clear ();
+  }
+  else
+  {
+    _tail.resize (length - _offset);
+  }
+
+  update ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void LogFile::remove ()
+{
+  _file.remove ();
+  _exists = false;
+  _offset = 0;
+  _tail.clear ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A file that did not exist before is written in one piece. Its temp file is
+// rewritten from the start each time, as write_raw writes at the current
+// position.
+void LogFile::update ()
+{
+  if (_exists)
+  {
+    _file.replace_tail (_offset, _tail);
+  }
+  else
+  {
+    _file.close ();
+    _file.truncate ();
+    _file.write_raw (_tail);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,61 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_LOGFILE
+#define INCLUDED_LOGFILE
+
+#include <AtomicFile.h>
+#include <FS.h>
+#include <string>
+
+// A LogFile is only ever changed at its end: content is appended, and recent
+// content is truncated away again. Changes are kept in memory and handed to
+// AtomicFile::replace_tail, so they are written when the command completes,
+// without copying or rewriting the start of the file.
+class LogFile
+{
+public:
+  explicit LogFile (const Path&);
+
+  bool exists () const;
+  size_t size () const;
+  std::string read (size_t offset, size_t length) const;
+  void append (const std::string&);
+  void truncate (size_t);
+  void remove ();
+
+private:
+  void update ();
+
+private:
+  Path        _path;
+  AtomicFile  _file;
+  bool        _exists {false};
+  size_t      _offset {0};
+  std::string _tail   {};
+};
+
+#endif
@@ -0,0 +1,112 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <MappedFile.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+////////////////////////////////////////////////////////////////////////////////
+MappedFile::~MappedFile ()
+{
+  close ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Returns false if the file cannot be mapped, in which case the caller should
+// fall back to reading it. An empty file is not mapped, but is still valid.
+bool MappedFile::open (const Path& path)
+{
+  close ();
+
+  int fd = ::open (path._data.c_str (), O_RDONLY);
+  if (fd == -1)
+  {
+    return false;
+  }
+
+  struct stat s;
+  if (::fstat (fd, &s) || ! S_ISREG (s.st_mode))
+  {
+    ::close (fd);
+    return false;
+  }
+
+  // The content and the modification time are both taken from this file, even
+  // if another is renamed over it later.
+#ifdef __APPLE__
+  _mtime = static_cast <int64_t> (s.st_mtimespec.tv_sec) * 1000000000 + s.st_mtimespec.tv_nsec;
+#else
+  _mtime = static_cast <int64_t> (s.st_mtim.tv_sec) * 1000000000 + s.st_mtim.tv_nsec;
+#endif
+
+  if (s.st_size > 0)
+  {
+    void* address = ::mmap (nullptr, s.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (address == MAP_FAILED)
+    {
+      ::close (fd);
+      return false;
+    }
+
+    _address = address;
+    _size = s.st_size;
+  }
+
+  // The mapping keeps its own reference to the file.
+  ::close (fd);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MappedFile::close ()
+{
+  if (_address != nullptr)
+  {
+    ::munmap (_address, _size);
+    _address = nullptr;
+    _size = 0;
+  }
+
+  _mtime = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string_view MappedFile::content () const
+{
+  return {static_cast <const char*> (_address), _size};
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The modification time of the mapped file, in nanoseconds, as DatafileIndex
+// records it.
+int64_t MappedFile::mtime () const
+{
+  return _mtime;
+}
+
+////////////////////////////////////////////////////////////////////////////////
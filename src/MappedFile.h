@@ -0,0 +1,59 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_MAPPEDFILE
+#define INCLUDED_MAPPEDFILE
+
+#include <FS.h>
+#include <cstdint>
+#include <string_view>
+
+// A read-only memory mapping of a whole file. The mapping stays valid even if
+// the file is later replaced by renaming another file over it, which is how
+// AtomicFile writes the data files. A file that is changed in place, with
+// AtomicFile::replace_tail, must not be mapped: a reader could see a torn
+// end, or fault on pages that were truncated away.
+class MappedFile
+{
+public:
+  MappedFile () = default;
+  MappedFile (const MappedFile&) = delete;
+  MappedFile& operator= (const MappedFile&) = delete;
+  ~MappedFile ();
+
+  bool open (const Path&);
+  void close ();
+
+  std::string_view content () const;
+  int64_t mtime () const;
+
+private:
+  void*   _address {nullptr};
+  size_t  _size    {0};
+  int64_t _mtime   {0};
+};
+
+#endif
@@ -0,0 +1,189 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <RangeSet.h>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////
+// Ranges are ordered by start, then by end, with an open end last. The ends of
+// the ranges in a set then never decrease.
+static bool startsBefore (const Range& left, const Range& right)
+{
+  if (left.start != right.start)
+    return left.start < right.start;
+
+  if (left.is_ended () && right.is_ended ())
+    return left.end < right.end;
+
+  return left.is_ended () && ! right.is_ended ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Whether left ends no later than right, an open end being the latest.
+static bool endsFirst (const Range& left, const Range& right)
+{
+  return left.is_ended () && (! right.is_ended () || left.end <= right.end);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+RangeSet::RangeSet (std::vector <Range> ranges)
+: _ranges (std::move (ranges))
+{
+  std::sort (_ranges.begin (), _ranges.end (), startsBefore);
+  coalesce (_ranges);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const std::vector <Range>& RangeSet::ranges () const
+{
+  return _ranges;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool RangeSet::empty () const
+{
+  return _ranges.empty ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+size_t RangeSet::size () const
+{
+  return _ranges.size ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Both sets are sorted already, so they are merged rather than sorted again.
+RangeSet RangeSet::unite (const RangeSet& other) const
+{
+  RangeSet result;
+  result._ranges.reserve (_ranges.size () + other._ranges.size ());
+  std::merge (_ranges.begin (), _ranges.end (),
+              other._ranges.begin (), other._ranges.end (),
+              std::back_inserter (result._ranges),
+              startsBefore);
+
+  coalesce (result._ranges);
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Of two overlapping ranges, the one that ends first cannot overlap any later
+// range of the other set, so it is the one to move past.
+RangeSet RangeSet::intersect (const RangeSet& other) const
+{
+  RangeSet result;
+
+  auto left = _ranges.begin ();
+  auto right = other._ranges.begin ();
+  while (left != _ranges.end () && right != other._ranges.end ())
+  {
+    if (left->overlaps (*right))
+    {
+      result._ranges.push_back (left->intersect (*right));
+    }
+
+    if (! left->is_started () || (right->is_started () && endsFirst (*left, *right)))
+      ++left;
+    else
+      ++right;
+  }
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+RangeSet RangeSet::subtract (const RangeSet& other) const
+{
+  RangeSet result;
+  for (auto& range : _ranges)
+  {
+    other.outside (range, result._ranges);
+  }
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Appends the parts of the range that lie outside this set, in order. The
+// result is that of subtracting each range of the set from it in turn with
+// Range::subtract, but only the ranges that may overlap it are visited.
+void RangeSet::outside (const Range& range, std::vector <Range>& results) const
+{
+  if (! range.is_started ())
+  {
+    results.push_back (range);
+    return;
+  }
+
+  // Skip the ranges that end before the range starts. Since the ends never
+  // decrease, they are found by binary search.
+  auto it = std::partition_point (_ranges.begin (), _ranges.end (),
+                                  [&range] (const Range& r)
+                                  {
+                                    return ! r.is_started () ||
+                                           (r.is_ended () && r.end <= range.start);
+                                  });
+
+  Range rest {range};
+  for (; it != _ranges.end (); ++it)
+  {
+    if (rest.is_ended () && it->start >= rest.end)
+      break;
+
+    if (! rest.overlaps (*it))
+      continue;
+
+    if (rest.start < it->start)
+      results.emplace_back (rest.start, it->start);
+
+    if (! it->is_ended () || (rest.is_ended () && rest.end <= it->end))
+      return;
+
+    rest.start = it->end;
+  }
+
+  results.push_back (rest);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Combines sorted ranges that overlap, in place.
+void RangeSet::coalesce (std::vector <Range>& ranges)
+{
+  size_t cursor = 0;
+  for (size_t i = 0; i < ranges.size (); ++i)
+  {
+    if (cursor && ranges[cursor - 1].overlaps (ranges[i]))
+      ranges[cursor - 1] = ranges[cursor - 1].combine (ranges[i]);
+    else
+      ranges[cursor++] = ranges[i];
+  }
+
+  ranges.resize (cursor);
+}
+
+////////////////////////////////////////////////////////////////////////////////
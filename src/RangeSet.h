@@ -0,0 +1,61 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_RANGESET
+#define INCLUDED_RANGESET
+
+#include <Range.h>
+#include <vector>
+
+// A set of time, held as ranges that are sorted by start and do not overlap.
+// As with Range::overlaps, ranges that only touch are kept apart, and ranges
+// without a start overlap nothing, so they are kept as they are.
+//
+// The operations sweep over both sets at once, instead of comparing every
+// range of one set with every range of the other.
+class RangeSet
+{
+public:
+  RangeSet () = default;
+  explicit RangeSet (std::vector <Range>);
+
+  const std::vector <Range>& ranges () const;
+  bool empty () const;
+  size_t size () const;
+
+  RangeSet unite (const RangeSet&) const;
+  RangeSet intersect (const RangeSet&) const;
+  RangeSet subtract (const RangeSet&) const;
+  void outside (const Range&, std::vector <Range>&) const;
+
+private:
+  static void coalesce (std::vector <Range>&);
+
+private:
+  std::vector <Range> _ranges {};
+};
+
+#endif
@@ -36,8 +36,16 @@
 #include <sstream>
 #include <tuple>
 
+////////////////////////////////////////////////////////////////////////////////
+static uint64_t nextGeneration ()
+{
+  static uint64_t last = 0;
+  return ++last;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 Rules::Rules ()
+: _generation (nextGeneration ())
 {
   // Load the default values.
   _settings =
@@ -86,6 +94,11 @@ Rules::Rules ()
     {"reports.month.holidays",   "yes"},
     {"reports.month.cell",       "15"},
 
+    // 'year' report.
+    {"reports.year.max",         "8"},
+    {"reports.year.tags",        "no"},
+    {"reports.year.summary",     "yes"},
+
     // 'summary' report.
     {"reports.summary.holidays", "yes"},
 
@@ -98,6 +111,9 @@ Rules::Rules ()
 
     // Options for the journal / undo file.
     {"journal.size",             "-1"},
+
+    // Stable ids of intervals, usable as '@#<id>'.
+    {"ids.stable",               "off"},
   };
 }
 
@@ -142,6 +158,13 @@ std::string Rules::file () const
   return _original_file;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// The files imported while loading, at any level of nesting.
+std::vector <std::string> Rules::imports () const
+{
+  return _imports;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 bool Rules::has (const std::string& key) const
 {
@@ -219,19 +242,26 @@ bool Rules::getBoolean (const std::string& key, bool defaultValue) const
 ////////////////////////////////////////////////////////////////////////////////
 void Rules::set (const std::string& key, const int value)
 {
-  _settings[key] = format (value);
+  set (key, format (value));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 void Rules::set (const std::string& key, const double value)
 {
-  _settings[key] = format (value, 1, 8);
+  set (key, format (value, 1, 8));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 void Rules::set (const std::string& key, const std::string& value)
 {
   _settings[key] = value;
+  _generation = nextGeneration ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+uint64_t Rules::generation () const
+{
+  return _generation;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -343,6 +373,7 @@ void Rules::parse (const std::string& input, int nest /* = 1 */)
           if (! imported.readable ())
             throw format ("Could not read imported file '{1}'.", imported._data);
 
+          _imports.push_back (imported._data);
           load (imported._data, nest + 1);
         }
 
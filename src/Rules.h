@@ -30,6 +30,7 @@
 #include <Database.h>
 #include <Journal.h>
 #include <Lexer.h>
+#include <cstdint>
 #include <map>
 #include <string>
 #include <vector>
@@ -40,6 +41,7 @@ public:
   Rules ();
   void load (const std::string&, int next = 1);
   std::string file () const;
+  std::vector <std::string> imports () const;
 
   bool        has        (const std::string&) const;
   std::string get (const std::string &key, const std::string &defaultValue = "") const;
@@ -54,6 +56,10 @@ public:
   std::vector <std::string> all (const std::string& stem = "") const;
   bool isRuleType (const std::string&) const;
 
+  // Changes with every setting, and differs between instances, so that what
+  // is compiled from the rules can be kept until they change.
+  uint64_t generation () const;
+
   std::string dump () const;
 
   static bool setConfigVariable (Journal& journal,
@@ -77,6 +83,8 @@ private:
 
 private:
   std::string                         _original_file {};
+  std::vector <std::string>           _imports       {};
+  uint64_t                            _generation    {0};
   std::map <std::string, std::string> _settings      {};
   std::vector <std::string>           _rule_types    {"tags", "reports", "theme", "holidays", "exclusions"};
 
@@ -0,0 +1,196 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <StableIdIndex.h>
+#include <cstdio>
+#include <random>
+#include <string_view>
+#include <timew.h>
+
+// The log is rewritten from the index once it holds more than twice as many
+// entries as there are ids, plus this many.
+static const size_t SLACK_ENTRIES = 64;
+
+////////////////////////////////////////////////////////////////////////////////
+static std::string formatEntry (uint64_t uid, int year, int month)
+{
+  char date[16];
+  snprintf (date, sizeof (date), "%04d-%02d", year, month);
+  return formatStableId (uid) + ' ' + date + '\n';
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void StableIdIndex::initialize (const std::string& location)
+{
+  _location = location;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool StableIdIndex::find (uint64_t uid, int& year, int& month)
+{
+  load ();
+
+  auto found = _months.find (uid);
+  if (found == _months.end ())
+  {
+    return false;
+  }
+
+  year = found->second.first;
+  month = found->second.second;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void StableIdIndex::set (uint64_t uid, int year, int month)
+{
+  _pending += formatEntry (uid, year, month);
+
+  if (_loaded)
+  {
+    _months[uid] = std::make_pair (year, month);
+    ++_entries;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void StableIdIndex::erase (uint64_t uid)
+{
+  _pending += formatStableId (uid) + " -\n";
+
+  if (_loaded)
+  {
+    _months.erase (uid);
+    ++_entries;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void StableIdIndex::commit ()
+{
+  if (_pending.empty ())
+  {
+    return;
+  }
+
+  if (_log == nullptr)
+  {
+    _log = std::make_unique <LogFile> (Path (_location + "/ids.log"));
+  }
+
+  if (_loaded && _entries > 2 * _months.size () + SLACK_ENTRIES)
+  {
+    std::string content;
+    for (auto& entry : _months)
+    {
+      content += formatEntry (entry.first, entry.second.first, entry.second.second);
+    }
+
+    _log->truncate (0);
+    _log->append (content);
+    _entries = _months.size ();
+  }
+  else
+  {
+    _log->append (_pending);
+  }
+
+  _pending.clear ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Ids are random, so that copies of a database kept on different machines are
+// unlikely to hand out the same id. Zero stands for 'no id'.
+uint64_t StableIdIndex::generate ()
+{
+  static std::mt19937_64 engine {std::random_device {} ()};
+
+  uint64_t uid;
+  do
+  {
+    uid = engine ();
+  }
+  while (uid == 0);
+
+  return uid;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Changes collected before the log was read are newer than the log, and are
+// applied last.
+void StableIdIndex::load ()
+{
+  if (_loaded)
+  {
+    return;
+  }
+
+  if (_log == nullptr)
+  {
+    _log = std::make_unique <LogFile> (Path (_location + "/ids.log"));
+  }
+
+  _entries = 0;
+  apply (_log->read (0, _log->size ()));
+  apply (_pending);
+  _loaded = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Lines that are not entries are ignored, and leave the index as it was.
+void StableIdIndex::apply (const std::string& content)
+{
+  std::string_view rest (content);
+  while (! rest.empty ())
+  {
+    auto end = rest.find ('\n');
+    auto line = rest.substr (0, end);
+    rest = end == std::string_view::npos ? std::string_view () : rest.substr (end + 1);
+
+    uint64_t uid = parseStableId (line.substr (0, 16));
+    if (uid == 0 || line.size () < 18 || line[16] != ' ')
+    {
+      continue;
+    }
+
+    ++_entries;
+
+    auto date = line.substr (17);
+    int year;
+    int month;
+    if (date == "-")
+    {
+      _months.erase (uid);
+    }
+    else if (date.size () == 7 &&
+             sscanf (std::string (date).c_str (), "%4d-%2d", &year, &month) == 2)
+    {
+      _months[uid] = std::make_pair (year, month);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
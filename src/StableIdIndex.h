@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_STABLEIDINDEX
+#define INCLUDED_STABLEIDINDEX
+
+#include <LogFile.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+// Maps the stable id of each interval to the month of the data file that holds
+// it. Entries are appended to ids.log as '<id> YYYY-MM', or '<id> -' once the
+// interval is deleted, and the last entry for an id wins. Only the month is
+// kept, because the line of an interval moves whenever an earlier interval is
+// inserted into the same file.
+//
+// The log is read only when an id is looked up. Until then, changes are only
+// collected, and appended to the log on commit.
+class StableIdIndex
+{
+public:
+  void initialize (const std::string&);
+  bool find (uint64_t, int&, int&);
+  void set (uint64_t, int, int);
+  void erase (uint64_t);
+  void commit ();
+
+  static uint64_t generate ();
+
+private:
+  void load ();
+  void apply (const std::string&);
+
+private:
+  std::string                                        _location {};
+  std::unique_ptr <LogFile>                          _log {};
+  bool                                               _loaded {false};
+  size_t                                             _entries {0};
+  std::unordered_map <uint64_t, std::pair <int, int>> _months {};
+  std::string                                        _pending {};
+};
+
+#endif
@@ -0,0 +1,185 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <AtomicFile.h>
+#include <FS.h>
+#include <StateFile.h>
+#include <fstream>
+#include <sstream>
+
+////////////////////////////////////////////////////////////////////////////////
+// The state file of the database at location, written with the configuration
+// files configs, timewarrior.cfg first.
+void StateFile::initialize (
+  const std::string& location,
+  const std::vector <std::string>& configs,
+  bool usable)
+{
+  _path = location + "/state";
+  _header = header (configs, usable);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Whether the file was written with the current configuration. Once it is
+// not, it is rewritten on commit even if no interval changed.
+bool StateFile::current () const
+{
+  std::ifstream in (_path);
+  std::string text;
+  std::vector <std::string> configs;
+  return readHeader (in, text, configs) && text == _header;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void StateFile::write (
+  const std::vector <std::string>& latest,
+  const std::vector <std::string>& tags)
+{
+  std::string content = _header;
+
+  for (auto& line : latest)
+  {
+    content += "interval " + line + '\n';
+  }
+
+  for (auto& tag : tags)
+  {
+    content += "tag " + tag + '\n';
+  }
+
+  AtomicFile::write (Path (_path), content);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reads the state file of the database at location, which must have been
+// written with the configuration file config, and the files it imports, as
+// they are now.
+bool StateFile::read (
+  const std::string& location,
+  const std::string& config,
+  std::vector <std::string>& latest,
+  std::vector <std::string>& tags)
+{
+  std::ifstream in (location + "/state");
+  std::string text;
+  std::vector <std::string> configs;
+  if (! readHeader (in, text, configs) ||
+      configs.empty ()                 ||
+      configs[0] != config             ||
+      text != header (configs, true))
+  {
+    return false;
+  }
+
+  std::string line;
+  while (std::getline (in, line))
+  {
+    if (line.compare (0, 9, "interval ") == 0)
+    {
+      latest.push_back (line.substr (9));
+    }
+    else if (line.compare (0, 4, "tag ") == 0)
+    {
+      tags.push_back (line.substr (4));
+    }
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A missing file is recorded with mtime and size 0, so that the header no
+// longer matches once it is created.
+std::string StateFile::header (const std::vector <std::string>& configs, bool usable)
+{
+  std::stringstream out;
+  out << "timew-state 2 " << (usable ? 1 : 0) << ' ' << configs.size () << '\n';
+
+  for (auto& config : configs)
+  {
+    File file (config);
+    out << "config "
+        << (file.exists () ? file.mtime () : 0) << ' '
+        << (file.exists () ? file.size () : 0) << ' '
+        << config << '\n';
+  }
+
+  return out.str ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reads the header lines as text, and the configuration files they list.
+bool StateFile::readHeader (
+  std::istream& in,
+  std::string& text,
+  std::vector <std::string>& configs)
+{
+  std::string line;
+  if (! std::getline (in, line))
+  {
+    return false;
+  }
+
+  std::istringstream first (line);
+  std::string magic;
+  int version;
+  int usable;
+  size_t count;
+  if (! (first >> magic >> version >> usable >> count) ||
+      magic != "timew-state"                          ||
+      version != 2)
+  {
+    return false;
+  }
+
+  text = line + '\n';
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    // config <mtime> <size> <path>, where the path may hold spaces.
+    std::string::size_type path = std::string::npos;
+    if (std::getline (in, line) && line.compare (0, 7, "config ") == 0)
+    {
+      auto size = line.find (' ', 7);
+      if (size != std::string::npos)
+      {
+        path = line.find (' ', size + 1);
+      }
+    }
+
+    if (path == std::string::npos)
+    {
+      return false;
+    }
+
+    configs.push_back (line.substr (path + 1));
+    text += line + '\n';
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
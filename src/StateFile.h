@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_STATEFILE
+#define INCLUDED_STATEFILE
+
+#include <istream>
+#include <string>
+#include <vector>
+
+// A small file next to the data files, rewritten on commit, that holds what
+// prompts ask for most: the latest intervals, newest first, and the tags
+// recently used. Reading it needs neither the rules, nor the extensions, nor
+// the data files.
+//
+// Format:
+//   timew-state 2 <usable> <number of config files>
+//   config <mtime> <size> <path>
+//   ...
+//   interval <serialization>
+//   ...
+//   tag <tag>
+//   ...
+//
+// The config lines are for timewarrior.cfg, then every file it imports. The
+// file only stands in for the database while all of these are as they were
+// when it was written, and only if that configuration is usable, that is it
+// neither excludes time nor turns on debugging, either of which changes what
+// the latest interval looks like.
+class StateFile
+{
+public:
+  void initialize (const std::string&, const std::vector <std::string>&, bool);
+  bool current () const;
+  void write (const std::vector <std::string>&, const std::vector <std::string>&);
+
+  static bool read (const std::string&, const std::string&, std::vector <std::string>&, std::vector <std::string>&);
+
+  // The number of intervals kept.
+  static const size_t intervals = 20;
+
+private:
+  static std::string header (const std::vector <std::string>&, bool);
+  static bool readHeader (std::istream&, std::string&, std::vector <std::string>&);
+
+private:
+  std::string _path   {};
+  std::string _header {};
+};
+
+#endif
@@ -0,0 +1,180 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <JSON.h>
+#include <TagCountCache.h>
+#include <cstdio>
+#include <format.h>
+#include <fstream>
+#include <sstream>
+#include <timew.h>
+#include <unistd.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// FNV-1a over the count lines of a month.
+static uint64_t checksum (const std::string& content)
+{
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (unsigned char c : content)
+  {
+    hash = (hash ^ c) * 0x100000001b3ULL;
+  }
+
+  return hash;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Format:
+//   <file> <size> <mtime> <number of tags> <checksum>
+//   <count> "<tag>"
+//   ...
+//
+// Reading stops at the first month that is incomplete or does not match its
+// checksum. The months before it are kept.
+bool TagCountCache::load (const Path& path)
+{
+  _months.clear ();
+
+  std::ifstream in (path._data);
+  if (! in.good ())
+  {
+    return false;
+  }
+
+  std::string header;
+  while (std::getline (in, header))
+  {
+    std::istringstream fields (header);
+    std::string name;
+    Month month;
+    size_t number;
+    uint64_t expected;
+
+    if (! (fields >> name >> month.size >> month.mtime >> number >> std::hex >> expected))
+    {
+      break;
+    }
+
+    std::string lines;
+    std::string line;
+    size_t read = 0;
+    while (read < number && std::getline (in, line))
+    {
+      auto space = line.find (' ');
+      if (space == std::string::npos || space == 0 ||
+          line.find_first_not_of ("0123456789") != space ||
+          line.length () < space + 3 ||
+          line[space + 1] != '"' ||
+          line.back () != '"')
+      {
+        break;
+      }
+
+      auto count = strtoul (line.substr (0, space).c_str (), nullptr, 10);
+      month.tags[json::decode (line.substr (space + 2, line.length () - space - 3))] = count;
+      lines += line + '\n';
+      ++read;
+    }
+
+    if (read != number || checksum (lines) != expected)
+    {
+      debug (format ("{1}: Tag counts of {2} are damaged", path.name (), name));
+      break;
+    }
+
+    _months[name] = month;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The cache is written under a temporary name first, and a cache that cannot
+// be written is simply missing the next time.
+bool TagCountCache::save (const Path& path) const
+{
+  std::stringstream out;
+  for (auto& month : _months)
+  {
+    std::string lines;
+    for (auto& tag : month.second.tags)
+    {
+      lines += std::to_string (tag.second) + " \"" + json::encode (tag.first) + "\"\n";
+    }
+
+    out << month.first << ' '
+        << month.second.size << ' '
+        << month.second.mtime << ' '
+        << month.second.tags.size () << ' '
+        << std::hex << checksum (lines) << std::dec << '\n'
+        << lines;
+  }
+
+  std::stringstream temp;
+  temp << path._data << '.' << ::getpid () << ".tmp";
+
+  {
+    std::ofstream file (temp.str (), std::ios::out | std::ios::trunc);
+    file << out.str ();
+    if (! file.good ())
+    {
+      std::remove (temp.str ().c_str ());
+      return false;
+    }
+  }
+
+  if (std::rename (temp.str ().c_str (), path._data.c_str ()))
+  {
+    std::remove (temp.str ().c_str ());
+    return false;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Returns the counts of the file, if they were recorded for a file of the
+// same size and modification time.
+const TagCountCache::counts* TagCountCache::find (const std::string& name, uint64_t size, int64_t mtime) const
+{
+  auto found = _months.find (name);
+  if (found == _months.end () ||
+      found->second.size  != size ||
+      found->second.mtime != mtime)
+  {
+    return nullptr;
+  }
+
+  return &found->second.tags;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void TagCountCache::set (const std::string& name, uint64_t size, int64_t mtime, const counts& tags)
+{
+  _months[name] = Month {size, mtime, tags};
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,62 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_TAGCOUNTCACHE
+#define INCLUDED_TAGCOUNTCACHE
+
+#include <FS.h>
+#include <cstdint>
+#include <map>
+#include <string>
+
+// Tag counts of every data file, each recorded together with the size and
+// modification time the file had when it was counted. The cache is kept in
+// tags.months, so that rebuilding the tag database only counts the months
+// that changed since the last rebuild. Each month is stored with a checksum
+// of its counts, and a month whose counts do not match it is counted again.
+class TagCountCache
+{
+public:
+  typedef std::map <std::string, unsigned int> counts;
+
+  bool load (const Path&);
+  bool save (const Path&) const;
+
+  const counts* find (const std::string&, uint64_t, int64_t) const;
+  void set (const std::string&, uint64_t, int64_t, const counts&);
+
+private:
+  struct Month
+  {
+    uint64_t size  {0};
+    int64_t  mtime {0};
+    counts   tags  {};
+  };
+
+  std::map <std::string, Month> _months {};
+};
+
+#endif
@@ -0,0 +1,142 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <TagDictionary.h>
+#include <algorithm>
+#include <cassert>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace
+{
+  // Names live in a deque, so that references to them stay valid as the
+  // dictionary grows.
+  std::deque <std::string>& names ()
+  {
+    static std::deque <std::string> instance;
+    return instance;
+  }
+
+  std::unordered_map <std::string, unsigned int>& byName ()
+  {
+    static std::unordered_map <std::string, unsigned int> instance;
+    return instance;
+  }
+
+  // Data files are read from several threads while the tag database is
+  // rebuilt, so the dictionary is guarded. Lookups of known tags only share
+  // the lock.
+  std::shared_mutex& guard ()
+  {
+    static std::shared_mutex instance;
+    return instance;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Returns the id of a tag, adding the tag if it is not known yet.
+unsigned int TagDictionary::id (const std::string& tag)
+{
+  auto& ids = byName ();
+
+  {
+    std::shared_lock <std::shared_mutex> lock (guard ());
+    auto found = ids.find (tag);
+    if (found != ids.end ())
+    {
+      return found->second;
+    }
+  }
+
+  std::unique_lock <std::shared_mutex> lock (guard ());
+  auto found = ids.find (tag);
+  if (found != ids.end ())
+  {
+    return found->second;
+  }
+
+  auto id = static_cast <unsigned int> (names ().size ());
+  names ().push_back (tag);
+  ids.emplace (tag, id);
+  return id;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Returns the sorted ids of a set of tags.
+std::vector <unsigned int> TagDictionary::ids (const std::set <std::string>& tags)
+{
+  std::vector <unsigned int> result;
+  result.reserve (tags.size ());
+  for (auto& tag : tags)
+  {
+    result.push_back (id (tag));
+  }
+
+  std::sort (result.begin (), result.end ());
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Returns the id of a tag, or none if the tag is not known. Unlike id, this
+// never adds the tag, so it only ever shares the lock.
+unsigned int TagDictionary::lookup (const std::string& tag)
+{
+  std::shared_lock <std::shared_mutex> lock (guard ());
+  auto& ids = byName ();
+  auto found = ids.find (tag);
+  return found != ids.end () ? found->second : none;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const std::string& TagDictionary::name (unsigned int id)
+{
+  std::shared_lock <std::shared_mutex> lock (guard ());
+  assert (id < names ().size ());
+  return names ()[id];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Orders ids by the names of their tags, which is the order tags are shown in.
+void TagDictionary::sortByName (std::vector <unsigned int>& ids)
+{
+  std::shared_lock <std::shared_mutex> lock (guard ());
+  auto& all = names ();
+  std::sort (ids.begin (), ids.end (), [&all] (unsigned int left, unsigned int right)
+  {
+    return all[left] < all[right];
+  });
+}
+
+////////////////////////////////////////////////////////////////////////////////
+size_t TagDictionary::size ()
+{
+  std::shared_lock <std::shared_mutex> lock (guard ());
+  return names ().size ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
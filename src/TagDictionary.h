@@ -0,0 +1,51 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_TAGDICTIONARY
+#define INCLUDED_TAGDICTIONARY
+
+#include <set>
+#include <string>
+#include <vector>
+
+// Process-wide mapping between tag names and small integer ids. Each distinct
+// tag is stored once, and ids are never reused, so intervals can hold and
+// compare tags as ids. The dictionary may be used from several threads.
+class TagDictionary
+{
+public:
+  static unsigned int id (const std::string&);
+  static std::vector <unsigned int> ids (const std::set <std::string>&);
+  static unsigned int lookup (const std::string&);
+  static const std::string& name (unsigned int);
+  static void sortByName (std::vector <unsigned int>&);
+  static size_t size ();
+
+  // Returned by lookup for a tag that is not known.
+  static const unsigned int none = static_cast <unsigned int> (-1);
+};
+
+#endif
@@ -45,6 +45,12 @@ unsigned int TagInfo::decrement ()
   return --_count;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+unsigned int TagInfo::count () const
+{
+  return _count;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 bool TagInfo::hasCount ()
 {
@@ -37,6 +37,7 @@ public:
   unsigned int increment ();
   unsigned int decrement ();
 
+  unsigned int count () const;
   bool hasCount ();
 
   std::string toJson ();
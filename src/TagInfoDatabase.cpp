@@ -27,8 +27,10 @@
 #include <JSON.h>
 #include <TagInfo.h>
 #include <TagInfoDatabase.h>
+#include <cctype>
 #include <format.h>
 #include <timew.h>
+#include <vector>
 
 ///////////////////////////////////////////////////////////////////////////////
 // Increment tag count
@@ -48,6 +50,7 @@ int TagInfoDatabase::incrementTag (const std::string& tag)
   }
 
   _is_modified = true;
+  _changed.insert (tag);
   return search->second.increment ();
 }
 
@@ -66,6 +69,7 @@ int TagInfoDatabase::decrementTag (const std::string& tag)
   }
 
   _is_modified = true;
+  _changed.insert (tag);
   return search->second.decrement ();
 }
 
@@ -75,6 +79,7 @@ int TagInfoDatabase::decrementTag (const std::string& tag)
 void TagInfoDatabase::add (const std::string& tag, const TagInfo& tagInfo)
 {
   _is_modified = true;
+  _changed.insert (tag);
   _tagInformation.emplace (tag, tagInfo);
 }
 
@@ -93,6 +98,12 @@ std::set <std::string> TagInfoDatabase::tags () const
   return tags;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+size_t TagInfoDatabase::size () const
+{
+  return _tagInformation.size ();
+}
+
 bool TagInfoDatabase::is_modified () const
 {
   return _is_modified;
@@ -101,6 +112,164 @@ bool TagInfoDatabase::is_modified () const
 void TagInfoDatabase::clear_modified ()
 {
   _is_modified = false;
+  _changed.clear ();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Load tags from JSON in the layout written by toJson, without building a
+// JSON DOM. Whitespace may differ, but anything else returns false and leaves
+// the database untouched, so that the caller can use the JSON parser instead.
+//
+bool TagInfoDatabase::fromJson (const std::string& content)
+{
+  std::vector <std::pair <std::string, unsigned int>> entries;
+  std::string::size_type i = 0;
+
+  auto skip = [&] ()
+  {
+    while (i < content.size () && std::isspace (static_cast <unsigned char> (content[i])))
+    {
+      ++i;
+    }
+  };
+
+  auto expect = [&] (char c)
+  {
+    skip ();
+    if (i < content.size () && content[i] == c)
+    {
+      ++i;
+      return true;
+    }
+
+    return false;
+  };
+
+  if (! expect ('{'))
+  {
+    return false;
+  }
+
+  if (! expect ('}'))
+  {
+    do
+    {
+      if (! expect ('"'))
+      {
+        return false;
+      }
+
+      auto start = i;
+      while (i < content.size () && content[i] != '"')
+      {
+        i += (content[i] == '\\') ? 2 : 1;
+      }
+
+      if (i >= content.size ())
+      {
+        return false;
+      }
+
+      auto key = json::decode (content.substr (start, i++ - start));
+
+      if (! expect (':') || ! expect ('{') || ! expect ('"') ||
+          content.compare (i, 6, "count\"") != 0)
+      {
+        return false;
+      }
+
+      i += 6;
+      if (! expect (':'))
+      {
+        return false;
+      }
+
+      skip ();
+      unsigned long count = 0;
+      auto digits = i;
+      while (i < content.size () && std::isdigit (static_cast <unsigned char> (content[i])) && i - digits < 9)
+      {
+        count = count * 10 + (content[i++] - '0');
+      }
+
+      if (i == digits || ! expect ('}'))
+      {
+        return false;
+      }
+
+      entries.emplace_back (key, count);
+    }
+    while (expect (','));
+
+    if (! expect ('}'))
+    {
+      return false;
+    }
+  }
+
+  skip ();
+  if (i != content.size ())
+  {
+    return false;
+  }
+
+  for (auto& entry : entries)
+  {
+    add (entry.first, TagInfo {entry.second});
+  }
+
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Apply the lines of a log written by toLog, in order. Each line sets the
+// count of one tag, so that a line that is applied twice does no harm.
+//
+// Returns the number of lines applied
+//
+size_t TagInfoDatabase::fromLog (const std::string& content)
+{
+  size_t lines = 0;
+  std::string::size_type start = 0;
+
+  while (start < content.size ())
+  {
+    auto eol = content.find ('\n', start);
+    if (eol == std::string::npos)
+    {
+      eol = content.size ();
+    }
+
+    auto line = content.substr (start, eol - start);
+    auto space = line.find (' ');
+
+    if (space == std::string::npos || space == 0 || space > 9 ||
+        line.find_first_not_of ("0123456789") != space ||
+        line.length () < space + 3 ||
+        line[space + 1] != '"' ||
+        line.back () != '"')
+    {
+      throw format ("Invalid tags log entry '{1}'.", line);
+    }
+
+    auto tag = json::decode (line.substr (space + 2, line.length () - space - 3));
+    auto count = static_cast <unsigned int> (std::stoul (line.substr (0, space)));
+
+    if (count == 0)
+    {
+      _tagInformation.erase (tag);
+    }
+    else
+    {
+      _tagInformation.insert_or_assign (tag, TagInfo {count});
+    }
+
+    _is_modified = true;
+    ++lines;
+    start = eol + 1;
+  }
+
+  return lines;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -129,3 +298,21 @@ std::string TagInfoDatabase::toJson ()
 
   return json.str ();
 }
+
+///////////////////////////////////////////////////////////////////////////////
+// Log entries for all tags changed since the last call to clear_modified
+//
+std::string TagInfoDatabase::toLog ()
+{
+  std::string log;
+
+  for (auto& tag : _changed)
+  {
+    auto search = _tagInformation.find (tag);
+    auto count = (search == _tagInformation.end ()) ? 0 : search->second.count ();
+
+    log += std::to_string (count) + " \"" + json::encode (tag) + "\"\n";
+  }
+
+  return log;
+}
@@ -41,14 +41,20 @@ public:
   void add (const std::string&, const TagInfo&);
 
   std::set <std::string> tags () const;
+  size_t size () const;
+
+  bool fromJson (const std::string&);
+  size_t fromLog (const std::string&);
 
   std::string toJson ();
+  std::string toLog ();
 
   bool is_modified () const;
   void clear_modified ();
 
 private:
   std::map <std::string, TagInfo> _tagInformation {};
+  std::set <std::string> _changed {};
   bool _is_modified {false};
 };
 
@@ -90,12 +90,13 @@ int CmdAnnotate (
   }
 
   // Apply annotation to intervals.
+  Database::WriteBatch batch;
   for (const auto& interval : intervals)
   {
     Interval modified {interval};
     modified.setAnnotation (annotation);
 
-    database.modifyInterval (interval, modified, verbose);
+    batch.modifyInterval (interval, modified);
 
     if (verbose)
     {
@@ -110,6 +111,8 @@ int CmdAnnotate (
     }
   }
 
+  database.apply (batch, verbose);
+
   journal.endTransaction ();
 
   return 0;
@@ -27,18 +27,24 @@
 #include <Chart.h>
 #include <ChartConfig.h>
 #include <Duration.h>
+#include <IntervalColumns.h>
 #include <IntervalFilterAllInRange.h>
 #include <IntervalFilterAllWithTags.h>
 #include <IntervalFilterAndGroup.h>
 #include <Range.h>
+#include <TagDictionary.h>
+#include <algorithm>
 #include <commands.h>
 #include <format.h>
 #include <iostream>
+#include <map>
+#include <sstream>
 #include <timew.h>
 
 int renderChart (const std::string&, const CLI&, Rules&, Database&);
-
-std::map <Datetime, std::string> createHolidayMap (Rules&, Range&);
+bool loadChartData (const std::string&, const CLI&, Rules&, Database&, Range&, IntervalColumns&);
+void renderNoData (const Range&, const std::set <std::string>&);
+std::string renderHeatmap (const std::vector <time_t>&, int, int, int, const Color&, const Color&);
 
 ////////////////////////////////////////////////////////////////////////////////
 int CmdChartDay (
@@ -68,59 +74,184 @@ int CmdChartMonth (
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-int renderChart (
-  const std::string& type,
+int CmdChartYear (
   const CLI& cli,
   Rules& rules,
   Database& database)
 {
-  const bool verbose = rules.getBoolean ("verbose");
+  Range range;
+  IntervalColumns tracked;
+  if (! loadChartData ("year", cli, rules, database, range, tracked))
+  {
+    return 0;
+  }
 
-  auto default_hint = rules.get ("reports.range", type);
-  auto report_hint = rules.get ("reports." + type + ".range", default_hint);
+  const auto max_hours = rules.getInteger ("reports.year.max");
 
-  Range default_range = {};
-  expandIntervalHint (":" + report_hint, default_range);
+  if (max_hours < 1)
+  {
+    throw std::string ("The value for 'reports.year.max' must be at least 1.");
+  }
 
-  auto range = cli.getRange (default_range);
-  auto tags = cli.getTags ();
+  const auto with_tags = cli.getComplementaryHint ("tags", rules.getBoolean ("reports.year.tags"));
+  const auto with_summary = rules.getBoolean ("reports.year.summary");
+  const auto with_colors = rules.getBoolean ("color");
 
-  // Load the data.
-  IntervalFilterAndGroup filtering ({
-    std::make_shared <IntervalFilterAllInRange> (range),
-    std::make_shared <IntervalFilterAllWithTags> (tags)
-  });
+  const Datetime now;
+  const time_t now_epoch = now.toEpoch ();
 
-  auto tracked = getTracked (database, rules, filtering);
+  // An unbounded range is narrowed down to the tracked data.
+  if (! range.is_started ())
+  {
+    range.start = Datetime (tracked.start (0));
+  }
 
-  if (tracked.empty ())
+  if (! range.is_ended ())
   {
-    if (verbose)
+    time_t last = now_epoch;
+    for (size_t i = 0; i < tracked.size (); ++i)
     {
-      std::cout << "No filtered data found";
+      last = std::max (last, static_cast <time_t> (tracked.end (i)));
+    }
+
+    range.end = Datetime (last);
+  }
+
+  const time_t range_start = range.start.toEpoch ();
+  const time_t range_end = range.end.toEpoch ();
+
+  if (range_end <= range_start)
+  {
+    return 0;
+  }
+
+  int y, m, d;
+  range.start.toYMD (y, m, d);
+  const int first_day = daysFromCivil (y, m, d);
+  Datetime (range_end - 1).toYMD (y, m, d);
+  const int last_day = daysFromCivil (y, m, d);
+  now.toYMD (y, m, d);
+  const int today = daysFromCivil (y, m, d);
+
+  const auto num_days = static_cast <size_t> (last_day - first_day + 1);
+
+  // One pass over the intervals sums up the seconds tracked on each day, in
+  // total and, if wanted, per tag.
+  std::vector <time_t> totals (num_days, 0);
+  std::map <unsigned int, std::vector <time_t>> tag_totals;
 
-      if (range.is_started ())
+  for (size_t i = 0; i < tracked.size (); ++i)
+  {
+    time_t start = std::max (static_cast <time_t> (tracked.start (i)), range_start);
+    time_t end = tracked.end (i) == 0 ? now_epoch : static_cast <time_t> (tracked.end (i));
+    end = std::min (end, range_end);
+
+    if (end <= start)
+    {
+      continue;
+    }
+
+    std::vector <std::vector <time_t>*> targets {&totals};
+
+    if (with_tags)
+    {
+      for (auto tag : tracked.tagIds (i))
       {
-        std::cout << " in the range " << range.start.toISOLocalExtended ();
-        if (range.is_ended ())
+        auto& days = tag_totals[tag];
+        if (days.empty ())
         {
-          std::cout << " - " << range.end.toISOLocalExtended ();
+          days.resize (num_days, 0);
         }
+
+        targets.push_back (&days);
       }
+    }
 
-      if (! tags.empty ())
+    Datetime (start).toYMD (y, m, d);
+    int day = daysFromCivil (y, m, d);
+
+    while (start < end)
+    {
+      civilFromDays (day + 1, y, m, d);
+      const time_t next = std::min (Datetime (y, m, d).toEpoch (), end);
+
+      for (auto target : targets)
       {
-        std::cout << " tagged with " << joinQuotedIfNeeded (", ", tags);
+        (*target)[day - first_day] += next - start;
       }
 
-      std::cout << ".\n";
+      start = next;
+      ++day;
     }
+  }
 
+  const Color color_today = with_colors ? Color (rules.get ("theme.colors.today")) : Color ("");
+  const Color color_label = with_colors ? Color (rules.get ("theme.colors.label")) : Color ("");
+
+  std::cout << renderHeatmap (totals, first_day, today, max_hours, color_today, Color (""));
+
+  if (with_tags)
+  {
+    auto palette = createPalette (rules);
+    const auto tag_colors = createTagColorMap (rules, palette, tracked);
+
+    // The busiest tags are listed first.
+    std::vector <std::pair <time_t, unsigned int>> order;
+    for (auto& entry : tag_totals)
+    {
+      time_t sum = 0;
+      for (auto seconds : entry.second)
+      {
+        sum += seconds;
+      }
+
+      order.emplace_back (sum, entry.first);
+    }
+
+    std::stable_sort (order.begin (), order.end (), [] (const std::pair <time_t, unsigned int>& a, const std::pair <time_t, unsigned int>& b) {
+      return a.first > b.first;
+    });
+
+    for (auto& entry : order)
+    {
+      const auto& name = TagDictionary::name (entry.second);
+      std::cout << color_label.colorize (name) << '\n';
+      std::cout << renderHeatmap (tag_totals[entry.second], first_day, today, max_hours, color_today, tag_colors.at (name));
+    }
+  }
+
+  if (with_summary)
+  {
+    time_t sum = 0;
+    for (auto seconds : totals)
+    {
+      sum += seconds;
+    }
+
+    std::cout << "Legend: . none, - less, + more, * most, # " << max_hours << " hours or more\n"
+              << "Tracked " << Duration (sum).formatHours () << '\n'
+              << '\n';
+  }
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int renderChart (
+  const std::string& type,
+  const CLI& cli,
+  Rules& rules,
+  Database& database)
+{
+  Range range;
+  IntervalColumns tracked;
+  if (! loadChartData (type, cli, rules, database, range, tracked))
+  {
     return 0;
   }
 
   const auto exclusions = getAllExclusions (rules, range);
-  const auto holidays = createHolidayMap (rules, range);
+  auto& holidays = getHolidays (rules);
 
   // Map tags to colors.
   auto palette = createPalette (rules);
@@ -170,36 +301,159 @@ int renderChart (
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-std::map <Datetime, std::string> createHolidayMap (Rules& rules, Range& range)
+// Finds the range of a chart of the given type, from the command line or the
+// range hints in the rules, and loads the tracked intervals within it that
+// carry the given tags. Without any, there is nothing to chart, which is
+// reported if verbose.
+bool loadChartData (
+  const std::string& type,
+  const CLI& cli,
+  Rules& rules,
+  Database& database,
+  Range& range,
+  IntervalColumns& tracked)
 {
-  std::map <Datetime, std::string> mapping;
-  auto holidays = rules.all ("holidays.");
+  auto default_hint = rules.get ("reports.range", type);
+  auto report_hint = rules.get ("reports." + type + ".range", default_hint);
+
+  Range default_range = {};
+  expandIntervalHint (":" + report_hint, default_range);
+
+  range = cli.getRange (default_range);
+  auto tags = cli.getTags ();
+
+  // Load the data.
+  IntervalFilterAndGroup filtering ({
+    std::make_shared <IntervalFilterAllInRange> (range),
+    std::make_shared <IntervalFilterAllWithTags> (tags)
+  });
+
+  tracked = getTrackedColumns (database, rules, filtering);
 
-  for (auto &entry : holidays)
+  if (tracked.empty ())
   {
-    auto first_dot = entry.find ('.');
-    auto last_dot = entry.rfind ('.');
+    if (rules.getBoolean ("verbose"))
+    {
+      renderNoData (range, tags);
+    }
+
+    return false;
+  }
+
+  return true;
+}
 
-    if (last_dot != std::string::npos)
+////////////////////////////////////////////////////////////////////////////////
+void renderNoData (
+  const Range& range,
+  const std::set <std::string>& tags)
+{
+  std::cout << "No filtered data found";
+
+  if (range.is_started ())
+  {
+    std::cout << " in the range " << range.start.toISOLocalExtended ();
+    if (range.is_ended ())
     {
-      auto date = entry.substr (last_dot + 1);
-      std::replace (date.begin (), date.end (), '_', '-');
-      Datetime holiday (date);
+      std::cout << " - " << range.end.toISOLocalExtended ();
+    }
+  }
 
-      if (holiday >= range.start && holiday <= range.end)
+  if (! tags.empty ())
+  {
+    std::cout << " tagged with " << joinQuotedIfNeeded (", ", tags);
+  }
+
+  std::cout << ".\n";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Renders the seconds tracked per day, starting on day number 'first_day', as
+// one calendar block per year: a column per week, a row per weekday, and one
+// glyph per day showing how close it came to 'max_hours'.
+std::string renderHeatmap (
+  const std::vector <time_t>& seconds,
+  const int first_day,
+  const int today,
+  const int max_hours,
+  const Color& color_today,
+  const Color& color_cell)
+{
+  static const char glyphs[] = ".-+*#";
+
+  const int last_day = first_day + static_cast <int> (seconds.size ()) - 1;
+  const time_t max_seconds = static_cast <time_t> (max_hours) * 3600;
+
+  int first_year, last_year, m, d;
+  civilFromDays (first_day, first_year, m, d);
+  civilFromDays (last_day, last_year, m, d);
+
+  std::stringstream out;
+
+  for (int year = first_year; year <= last_year; ++year)
+  {
+    // Weeks start on Monday, so the first column holds the Monday on or
+    // before January 1st.
+    const int jan1 = daysFromCivil (year, 1, 1);
+    const int dec31 = daysFromCivil (year, 12, 31);
+    const int origin = jan1 - ((jan1 + 3) % 7 + 7) % 7;
+    const int num_weeks = (dec31 - origin) / 7 + 1;
+
+    // Month labels sit above the week of the 1st, as long as they fit.
+    std::string header = std::to_string (year);
+    header.resize (5, ' ');
+    for (int month = 1; month <= 12; ++month)
+    {
+      const auto column = 5 + static_cast <size_t> ((daysFromCivil (year, month, 1) - origin) / 7);
+      if (column >= header.length ())
       {
-        std::stringstream out;
-        out << " ["
-            << entry.substr (first_dot + 1, last_dot - first_dot - 1)
-            << "] "
-            << rules.get (entry);
-        auto locale = entry.substr (first_dot + 1, last_dot - first_dot - 1);
-        mapping[holiday] = out.str ();
+        header.resize (column, ' ');
+        header += Datetime::monthNameShort (month);
       }
     }
+
+    out << header << '\n';
+
+    for (int row = 0; row < 7; ++row)
+    {
+      std::string line = Datetime::dayNameShort ((row + 1) % 7) + "  ";
+      size_t used = line.length ();
+
+      for (int week = 0; week < num_weeks; ++week)
+      {
+        const int day = origin + week * 7 + row;
+        if (day < jan1 || day > dec31 || day < first_day || day > last_day)
+        {
+          line += ' ';
+          continue;
+        }
+
+        const auto tracked = seconds[day - first_day];
+        const int level = tracked <= 0 ? 0 : 1 + static_cast <int> (std::min (time_t (3), tracked * 3 / max_seconds));
+        const std::string glyph (1, glyphs[level]);
+
+        if (day == today)
+        {
+          line += color_today.colorize (glyph);
+        }
+        else if (level > 0)
+        {
+          line += color_cell.colorize (glyph);
+        }
+        else
+        {
+          line += glyph;
+        }
+
+        used = line.length ();
+      }
+
+      line.resize (used);
+      out << line << '\n';
+    }
+
+    out << '\n';
   }
 
-  return mapping;
+  return out.str ();
 }
-
-////////////////////////////////////////////////////////////////////////////////
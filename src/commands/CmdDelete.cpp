@@ -73,9 +73,10 @@ int CmdDelete (
     }
   }
 
+  Database::WriteBatch batch;
   for (const auto& interval : intervals)
   {
-    database.deleteInterval (interval);
+    batch.deleteInterval (interval);
 
     if (verbose)
     {
@@ -83,6 +84,8 @@ int CmdDelete (
     }
   }
 
+  database.apply (batch, verbose);
+
   journal.endTransaction ();
 
   return 0;
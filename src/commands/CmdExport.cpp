@@ -65,7 +65,7 @@ int CmdExport (
     );
   }
 
-  auto intervals = getTracked (database, rules, *filtering);
+  auto intervals = getTrackedColumns (database, rules, *filtering);
 
   std::cout << jsonFromIntervals (intervals);
 
@@ -24,6 +24,7 @@
 //
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <DayBuckets.h>
 #include <Duration.h>
 #include <Table.h>
 #include <commands.h>
@@ -76,14 +77,24 @@ int CmdGaps (
   // Each day is rendered separately.
   time_t grand_total = 0;
   Datetime previous;
+  std::vector <Range> days;
   for (Datetime day = range.start; day < range.end; day++)
   {
-    auto day_range = getFullDay (day);
+    days.push_back (getFullDay (day));
+  }
+
+  DayBuckets buckets (untracked, days);
+
+  for (size_t d = 0; d < days.size (); ++d)
+  {
+    const auto& day_range = days[d];
+    const auto& day = day_range.start;
     time_t daily_total = 0;
 
     int row = -1;
-    for (auto& gap : subset (day_range, untracked))
+    for (auto i : buckets.bucket (d))
     {
+      auto& gap = untracked[i];
       row = table.addRow ();
 
       if (day != previous)
@@ -67,6 +67,7 @@ int CmdHelpUsage (const Extensions& extensions)
             << "       timew undo\n"
             << "       timew untag @<id> [@<id> ...] <tag> [<tag> ...]\n"
             << "       timew week [<interval>] [<tag> ...]\n"
+            << "       timew year [<interval>] [<tag> ...]\n"
             << '\n';
 
   if (!extensions.all ().empty ())
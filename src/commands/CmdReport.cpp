@@ -142,7 +142,7 @@ int CmdReport (
     std::make_shared <IntervalFilterAllWithTags> (tags)
   });
 
-  auto tracked = getTracked (database, rules, filtering);
+  auto tracked = getTrackedColumns (database, rules, filtering);
 
   // Compose Header info.
   rules.set ("temp.report.start", range.is_started () ? range.start.toISO () : "");
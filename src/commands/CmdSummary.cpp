@@ -24,6 +24,7 @@
 //
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <DayBuckets.h>
 #include <Duration.h>
 #include <IntervalFilterAllInRange.h>
 #include <IntervalFilterAllWithTags.h>
@@ -35,9 +36,7 @@
 #include <timew.h>
 #include <utf8.h>
 
-// Implemented in CmdChart.cpp.
-std::map <Datetime, std::string> createHolidayMap (Rules&, Range&);
-std::string renderHolidays (const std::map <Datetime, std::string>&);
+std::string renderHolidays (const Range&, const HolidayCalendar&);
 
 ////////////////////////////////////////////////////////////////////////////////
 int CmdSummary (
@@ -62,7 +61,7 @@ int CmdSummary (
     std::make_shared <IntervalFilterAllWithTags> (tags)
   });
 
-  auto tracked = getTracked (database, rules, filtering);
+  auto tracked = getTrackedColumns (database, rules, filtering);
 
   if (tracked.empty ())
   {
@@ -162,8 +161,8 @@ int CmdSummary (
   time_t grand_total = 0;
   Datetime previous;
 
-  auto days_start = range.is_started() ? range.start : tracked.front ().start;
-  auto days_end   = range.is_ended()   ? range.end   : tracked.back ().end;
+  auto days_start = range.is_started() ? range.start : Datetime (tracked.start (0));
+  auto days_end   = range.is_ended()   ? range.end   : Datetime (tracked.end (tracked.size () - 1));
 
   const auto now = Datetime ();
 
@@ -172,14 +171,25 @@ int CmdSummary (
     days_end = now;
   }
 
+  std::vector <Range> days;
   for (Datetime day = days_start.startOfDay (); day < days_end; ++day)
   {
-    auto day_range = getFullDay (day);
+    days.push_back (getFullDay (day));
+  }
+
+  DayBuckets buckets (tracked, days);
+
+  for (size_t d = 0; d < days.size (); ++d)
+  {
+    const auto& day_range = days[d];
+    const auto& day = day_range.start;
     time_t daily_total = 0;
 
     int row = -1;
-    for (auto& track : subset (day_range, tracked))
+    for (auto i : buckets.bucket (d))
     {
+      auto track = tracked.interval (i);
+
       // Make sure the track only represents one day.
       if ((track.is_open () && day > now))
       {
@@ -263,22 +273,25 @@ int CmdSummary (
 
   std::cout << '\n'
             << table.render ()
-            << (show_holidays ? renderHolidays (createHolidayMap (rules, range)) : "")
+            << (show_holidays ? renderHolidays (range, getHolidays (rules)) : "")
             << '\n';
 
   return 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-std::string renderHolidays (const std::map<Datetime, std::string> &holidays)
+std::string renderHolidays (const Range& range, const HolidayCalendar& holidays)
 {
   std::stringstream out;
 
-  for (auto &entry : holidays)
+  auto slice = holidays.slice (range);
+  for (auto entry = slice.first; entry != slice.second; ++entry)
   {
-    out << entry.first.toString ("Y-M-D")
-        << " "
-        << entry.second
+    out << HolidayCalendar::date (entry->day)
+        << "  ["
+        << entry->locale
+        << "] "
+        << entry->name
         << '\n';
   }
 
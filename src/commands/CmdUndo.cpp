@@ -29,12 +29,25 @@
 #include <format.h>
 #include <iostream>
 
-static void undoIntervalAction(UndoAction& action, Database& database)
+static void undoIntervalAction(UndoAction& action, Database::WriteBatch& batch)
 {
   Interval before = IntervalFactory::fromJson (action.getBefore ());
   Interval after = IntervalFactory::fromJson (action.getAfter ());
 
-  database.modifyInterval (after, before, false);
+  batch.modifyInterval (after, before);
+}
+
+static void undoIntervalsAction (UndoAction& action, Database::WriteBatch& batch)
+{
+  for (auto& interval : IntervalFactory::fromJsonArray (action.getAfter ()))
+  {
+    batch.deleteInterval (interval);
+  }
+
+  for (auto& interval : IntervalFactory::fromJsonArray (action.getBefore ()))
+  {
+    batch.addInterval (interval);
+  }
 }
 
 static void undoConfigAction (UndoAction& action, Rules &rules, Journal& journal)
@@ -77,6 +90,10 @@ int CmdUndo (Rules& rules, Database& database, Journal& journal)
   }
   else
   {
+    // All changes to intervals are rolled back together, in one pass over
+    // each data file.
+    Database::WriteBatch batch;
+
     for (auto& action : actions)
     {
       // Select database...
@@ -85,7 +102,11 @@ int CmdUndo (Rules& rules, Database& database, Journal& journal)
       // Rollback action...
       if (type == "interval")
       {
-        undoIntervalAction (action, database);
+        undoIntervalAction (action, batch);
+      }
+      else if (type == "intervals")
+      {
+        undoIntervalsAction (action, batch);
       }
       else if (type == "config")
       {
@@ -97,6 +118,8 @@ int CmdUndo (Rules& rules, Database& database, Journal& journal)
       }
     }
 
+    database.apply (batch, false);
+
     if (verbose)
     {
       std::cout << "Undo" << std::endl;
@@ -99,6 +99,7 @@ int CmdUntag (
   }
 
   // Remove tags from intervals.
+  Database::WriteBatch batch;
   for (const auto& interval : intervals)
   {
     Interval modified {interval};
@@ -108,7 +109,7 @@ int CmdUntag (
       modified.untag (tag);
     }
 
-    database.modifyInterval (interval, modified, verbose);
+    batch.modifyInterval (interval, modified);
 
     if (verbose)
     {
@@ -116,6 +117,8 @@ int CmdUntag (
     }
   }
 
+  database.apply (batch, verbose);
+
   journal.endTransaction ();
 
   return 0;
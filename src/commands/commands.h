@@ -67,6 +67,7 @@ int CmdUntag         (const CLI&, Rules&, Database&, Journal&
 int CmdChartDay      (const CLI&, Rules&, Database&                             );
 int CmdChartWeek     (const CLI&, Rules&, Database&                             );
 int CmdChartMonth    (const CLI&, Rules&, Database&                             );
+int CmdChartYear     (const CLI&, Rules&, Database&                             );
 int CmdSummary       (const CLI&, Rules&, Database&                             );
 
 #endif
@@ -26,35 +26,73 @@
 
 #include <Datetime.h>
 #include <Duration.h>
+#include <IntervalExpansion.h>
 #include <IntervalFactory.h>
 #include <IntervalFilter.h>
+#include <RangeSet.h>
 #include <algorithm>
+#include <cstdint>
 #include <format.h>
 #include <shared.h>
 #include <timew.h>
 
 ////////////////////////////////////////////////////////////////////////////////
-// Read rules and extract all holiday definitions. Create a Range for each
-// one that spans from midnight to midnight.
-std::vector <Range> getHolidays (const Rules& rules)
+// Holds what one function compiles from the rules. It is compiled again only
+// once the rules it was compiled from change, which their generation tells.
+template <typename T>
+class CompiledRules
 {
-  std::vector <Range> results;
-  for (auto& holiday : rules.all ("holidays."))
+public:
+  explicit CompiledRules (T (*compile) (const Rules&)) : _compile (compile) {}
+
+  const T& get (const Rules& rules)
   {
-    auto lastDot = holiday.rfind ('.');
-    if (lastDot != std::string::npos)
+    if (rules.generation () != _generation)
     {
-      Range r;
-      Datetime d (holiday.substr (lastDot + 1), "Y_M_D");
-      r.start = d;
-      ++d;
-      r.end = d;
-      results.push_back (r);
+      _value = _compile (rules);
+      _generation = rules.generation ();
     }
+
+    return _value;
   }
 
-  debug (format ("Found {1} holidays", results.size ()));
-  return results;
+private:
+  T (*_compile) (const Rules&);
+  T        _value      {};
+  uint64_t _generation {0};
+};
+
+////////////////////////////////////////////////////////////////////////////////
+static HolidayCalendar compileHolidays (const Rules& rules)
+{
+  HolidayCalendar holidays (rules);
+  debug (format ("Found {1} holidays", holidays.size ()));
+  return holidays;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static std::vector <Exclusion> compileExclusions (const Rules& rules)
+{
+  std::vector <Exclusion> exclusions;
+  for (auto& name : rules.all ("exclusions."))
+    exclusions.emplace_back (lowerCase (name), rules.get (name));
+
+  return exclusions;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Read rules and extract all holiday definitions.
+const HolidayCalendar& getHolidays (const Rules& rules)
+{
+  static CompiledRules <HolidayCalendar> holidays (compileHolidays);
+  return holidays.get (rules);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static const std::vector <Exclusion>& compiledExclusions (const Rules& rules)
+{
+  static CompiledRules <std::vector <Exclusion>> exclusions (compileExclusions);
+  return exclusions.get (rules);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -73,14 +111,11 @@ std::vector <Range> getAllExclusions (
   const Rules& rules,
   const Range& range)
 {
-  // Start with the set of all holidays, intersected with range.
-  std::vector <Range> results;
-  results = addRanges (range, results, getHolidays (rules));
+  // Start with the set of all holidays that overlap the range.
+  auto days = getHolidays (rules).ranges (range);
 
   // Load all exclusions from configuration.
-  std::vector <Exclusion> exclusions;
-  for (auto& name : rules.all ("exclusions."))
-    exclusions.emplace_back (lowerCase (name), rules.get (name));
+  auto& exclusions = compiledExclusions (rules);
   debug (format ("Found {1} exclusions", exclusions.size ()));
 
   // Find exclusions 'exc day on <date>' and remove from holidays.
@@ -101,14 +136,16 @@ std::vector <Range> getAllExclusions (
   }
 
   // daysOff are combined with existing holidays.
-  results = addRanges (range, results, daysOff);
+  for (auto& r : daysOff)
+    if (range.overlaps (r))
+      days.push_back (r);
   if (! daysOn.empty ())
     debug (format ("Found {1} additional working days", daysOn.size ()));
   if (! daysOff.empty ())
     debug (format ("Found {1} additional non-working days", daysOff.size ()));
 
   // daysOn are subtracted from the existing holidays.
-  results = subtractRanges (results, daysOn);
+  auto results = RangeSet (days).subtract (RangeSet (daysOn));
 
   // Expand all exclusions that are not 'exc day ...' into excluded ranges that
   // overlap with range.
@@ -119,7 +156,7 @@ std::vector <Range> getAllExclusions (
     {
       for (auto& r : exclusion.ranges (range))
       {
-        if (!r.is_empty ())
+        if (!r.is_empty () && range.overlaps (r))
         {
           exclusionRanges.push_back (r);
         }
@@ -127,7 +164,7 @@ std::vector <Range> getAllExclusions (
     }
   }
 
-  return merge (addRanges (range, results, exclusionRanges));
+  return results.unite (RangeSet (exclusionRanges)).ranges ();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -135,37 +172,13 @@ std::vector <Range> getAllExclusions (
 // intervals.
 std::vector <Interval> expandLatest (const Interval& latest, const Rules& rules)
 {
-  int current_id = 0;
   std::vector <Interval> intervals;
-  // If the latest interval is open, check for synthetic intervals
-  if (latest.is_open ())
-  {
-    auto exclusions = getAllExclusions (rules, {latest.start, Datetime ()});
-    if (! exclusions.empty ())
-    {
-      std::vector <Interval> flattened = flatten (latest, exclusions);
 
-      // If flatten() converted the latest interval into a group of synthetic
-      // intervals, the number of returned intervals will be greater than 1.
-      // Otherwise, it just returned the non-synthetic, latest interval.
-      if (flattened.size () > 1)
-      {
-        std::reverse (flattened.begin (), flattened.end ());
-        for (auto interval : flattened)
-        {
-          interval.synthetic = true;
-          interval.id = ++current_id;
-          intervals.push_back (std::move (interval));
-        }
-      }
-    }
-  }
+  IntervalExpansion expansion (latest, rules);
+  Interval interval;
+  while (expansion.next (interval))
+    intervals.push_back (interval);
 
-  if (intervals.empty ())
-  {
-    intervals.push_back (latest);
-    intervals.back().id = 1;
-  }
   return intervals;
 }
 
@@ -231,8 +244,11 @@ std::vector <Interval> flatten (
     if (interval.encloses (e))
       enclosed.push_back (e);
 
+  std::vector <Range> results;
+  RangeSet (enclosed).outside (interval, results);
+
   Datetime now;
-  for (auto& result : subtractRanges ({interval}, enclosed))
+  for (auto& result : results)
   {
     if (interval.is_open() && result.start > now)
     {
@@ -250,79 +266,24 @@ std::vector <Interval> flatten (
 
 ////////////////////////////////////////////////////////////////////////////////
 // Simply merges a vector of ranges, without data loss.
-static bool rangeCompare (Range left, Range right)
-{
-  return left.start < right.start;
-}
-
 std::vector <Range> merge (
   const std::vector <Range>& ranges)
 {
-  // Shortcut.
-  if (ranges.size () < 2)
-    return ranges;
-
-  std::vector <Range> sorted {ranges};
-  std::sort (sorted.begin (), sorted.end (), rangeCompare);
-
-  unsigned int cursor = 0;
-  int merges = 0;
-  for (unsigned int i = 0; i < sorted.size (); ++i)
-  {
-    if (cursor && sorted[cursor - 1].overlaps (sorted[i]))
-    {
-      sorted[cursor - 1] = sorted[cursor - 1].combine (sorted[i]);
-      ++merges;
-    }
-    else
-    {
-      sorted[cursor] = sorted[i];
-      ++cursor;
-    }
-  }
-
-  if (merges)
-    sorted.resize (ranges.size () - merges);
-
-  return sorted;
-}
-
-////////////////////////////////////////////////////////////////////////////////
-// Subset both ranges and additions by limits, and combine.
-std::vector <Range> addRanges (
-  const Range& limits,
-  const std::vector <Range>& ranges,
-  const std::vector <Range>& additions)
-{
-  std::vector <Range> results;
-
-  for (auto& range : ranges)
-    if (limits.overlaps (range))
-      results.push_back (range);
-
-  for (auto& addition : additions)
-    if (limits.overlaps (addition))
-      results.push_back (addition);
-
-  return results;
+  return RangeSet (ranges).ranges ();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Subtract a set of Ranges from another set of Ranges, all within a defined range.
+// Subtract a set of Ranges from another set of Ranges, all within a defined
+// range. The ranges are kept apart, and in their order.
 std::vector <Range> subtractRanges (
   const std::vector <Range>& ranges,
   const std::vector <Range>& subtractions)
 {
-  std::vector <Range> results = ranges;
-  for (auto& s : subtractions)
-  {
-    std::vector <Range> split_results;
-    for (auto& range : results)
-      for (auto& split_range : range.subtract (s))
-        split_results.push_back (split_range);
+  RangeSet set (subtractions);
 
-    results = split_results;
-  }
+  std::vector <Range> results;
+  for (auto& range : ranges)
+    set.outside (range, results);
 
   return results;
 }
@@ -375,14 +336,7 @@ bool matchesFilter (const Interval& interval, const Interval& filter)
 {
   if (matchesRange (interval, filter))
   {
-    for (auto& tag : filter.tags ())
-    {
-      if (! interval.hasTag (tag))
-      {
-        return false;
-      }
-    }
-    return true;
+    return interval.hasTags (filter.tagIds ());
   }
 
   return false;
@@ -409,49 +363,72 @@ Interval clip (const Interval& interval, const Range& range)
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Return collection of intervals that match the filter (synthetic intervals
-// included) sorted by date
-std::vector <Interval> getTracked (
+// Visits the tracked intervals that match the filter, newest first, with their
+// ids set.
+template <typename Visitor>
+static void forEachTracked (
   Database& database,
   const Rules& rules,
-  IntervalFilter& filter)
+  IntervalFilter& filter,
+  Visitor visit)
 {
   int current_id = 0;
-  std::vector <Interval> intervals;
 
   auto it = database.begin ();
   auto end = database.end ();
 
   // Because the latest recorded interval may be expanded into synthetic
-  // intervals, we'll handle it specially
+  // intervals, we'll handle it specially. They are expanded only as far as
+  // the filter takes them.
   if (it != end )
   {
-    Interval latest = IntervalFactory::fromSerialization (*it);
+    IntervalExpansion expansion (it.interval (), rules);
     ++it;
 
-    for (auto& interval : expandLatest (latest, rules))
+    Interval interval;
+    while (! filter.is_done () && expansion.next (interval))
     {
       ++current_id;
       if (filter.accepts (interval))
       {
         interval.id = current_id;
-        intervals.push_back (interval);
-      }
-      else if (filter.is_done ())
-      {
-        break;
+        visit (std::move (interval));
       }
     }
+
+    if (filter.is_done ())
+    {
+      return;
+    }
+  }
+
+  // Months that start at or after the end of the filter range cannot hold a
+  // match, so they are skipped. Only their size counts towards the ids.
+  auto range = filter.range ();
+  if (range.is_ended ())
+  {
+    current_id += it.skipFrom (range.end);
   }
 
   for (; it != end; ++it)
   {
-    Interval interval = IntervalFactory::fromSerialization(*it);
+    // Intervals before the next id the filter accepts are only counted.
+    auto next_id = filter.next_id ();
+    if (next_id > current_id + 1)
+    {
+      current_id += it.skip (next_id - current_id - 1);
+      if (it == end)
+      {
+        break;
+      }
+    }
+
+    Interval interval = it.interval ();
     interval.id = ++current_id;
 
     if (filter.accepts (interval))
     {
-      intervals.push_back (std::move (interval));
+      visit (std::move (interval));
     }
     else if (filter.is_done ())
     {
@@ -461,6 +438,21 @@ std::vector <Interval> getTracked (
       break;
     }
   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Return collection of intervals that match the filter (synthetic intervals
+// included) sorted by date
+std::vector <Interval> getTracked (
+  Database& database,
+  const Rules& rules,
+  IntervalFilter& filter)
+{
+  std::vector <Interval> intervals;
+  forEachTracked (database, rules, filter, [&intervals] (Interval&& interval)
+  {
+    intervals.push_back (std::move (interval));
+  });
 
   debug (format ("Loaded {1} tracked intervals", intervals.size ()));
 
@@ -471,6 +463,26 @@ std::vector <Interval> getTracked (
   return intervals;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Same as getTracked, but collects the intervals into a column store, which
+// takes much less memory for reports over many intervals.
+IntervalColumns getTrackedColumns (
+  Database& database,
+  const Rules& rules,
+  IntervalFilter& filter)
+{
+  IntervalColumns columns;
+  forEachTracked (database, rules, filter, [&columns] (Interval&& interval)
+  {
+    columns.add (interval);
+  });
+
+  debug (format ("Loaded {1} tracked intervals", columns.size ()));
+
+  columns.reverse ();
+  return columns;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Untracked time is that which is not excluded, and not filled. Gaps.
 std::vector <Range> getUntracked (
@@ -480,9 +492,17 @@ std::vector <Range> getUntracked (
 {
   bool found_match = false;
   std::vector <Range> inclusion_ranges;
-  for (auto& line : database)
+  auto end = database.end ();
+  auto it = database.begin ();
+
+  if (filter.is_ended ())
+  {
+    it.skipFrom (filter.end);
+  }
+
+  for (; it != end; ++it)
   {
-    Interval i = IntervalFactory::fromSerialization (line);
+    Interval i = it.interval ();
     if (matchesFilter (i, filter))
     {
       inclusion_ranges.push_back (i);
@@ -497,8 +517,8 @@ std::vector <Range> getUntracked (
     }
   }
 
-  auto available = subtractRanges ({filter}, getAllExclusions (rules, filter));
-  auto untracked = subtractRanges (available, inclusion_ranges);
+  auto available = RangeSet ({filter}).subtract (RangeSet (getAllExclusions (rules, filter)));
+  auto untracked = available.subtract (RangeSet (inclusion_ranges)).ranges ();
   debug (format ("Loaded {1} untracked ranges", untracked.size ()));
   return untracked;
 }
@@ -517,6 +537,36 @@ Interval getLatestInterval (Database& database)
   return i;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Turns each '@#<id>' on the command line into the '@<id>' it currently has.
+// Should the latest interval be expanded into synthetic intervals, the id
+// stays with the oldest of them, as flattenDatabase does.
+void resolveStableIds (CLI& cli, Database& database, const Rules& rules)
+{
+  auto uids = cli.getStableIds ();
+  if (uids.empty ())
+  {
+    return;
+  }
+
+  size_t expanded = 0;
+  for (auto uid : uids)
+  {
+    auto position = database.positionOf (uid);
+    if (position == 0)
+    {
+      throw format ("'@#{1}' does not correspond to any tracking.", formatStableId (uid));
+    }
+
+    if (expanded == 0)
+    {
+      expanded = expandLatest (getLatestInterval (database), rules).size ();
+    }
+
+    cli.resolveStableId (uid, static_cast <int> (expanded + position - 1));
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 Range getFullDay (const Datetime& day)
 {
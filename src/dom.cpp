@@ -35,6 +35,83 @@
 #include <timew.h>
 #include <vector>
 
+////////////////////////////////////////////////////////////////////////////////
+// Resolves dom.active and dom.active.<...>, given the latest interval, which is
+// empty if nothing was tracked yet.
+bool domGetActive (
+  const Interval& latest,
+  const std::string& reference,
+  std::string& value)
+{
+  Pig pig (reference);
+  if (! pig.skipLiteral ("dom.active"))
+  {
+    return false;
+  }
+
+  // dom.active
+  if (pig.eos ())
+  {
+    value = ! latest.empty () && latest.is_open () ? "1" : "0";
+    return true;
+  }
+
+  if (latest.empty ())
+  {
+    return false;
+  }
+
+  // dom.active.start
+  if (pig.skipLiteral (".start") &&
+      latest.is_open ())
+  {
+    value = latest.start.toISOLocalExtended ();
+    return true;
+  }
+
+  // dom.active.duration
+  if (pig.skipLiteral (".duration") &&
+      latest.is_open ())
+  {
+    value = Duration (latest.total ()).formatISO ();
+    return true;
+  }
+
+  // dom.active.tag.count
+  if (pig.skipLiteral (".tag.count") &&
+      latest.is_open ())
+  {
+    value = format ("{1}", latest.tags ().size ());
+    return true;
+  }
+
+  // dom.active.json
+  if (pig.skipLiteral (".json") &&
+      latest.is_open ())
+  {
+    value = latest.json ();
+    return true;
+  }
+
+  // dom.active.tag.<N>
+  int n;
+  if (pig.skipLiteral (".tag.") &&
+      pig.getDigits (n))
+  {
+    if (1 <= n && n <= static_cast <int> (latest.tags ().size ()))
+    {
+      std::vector <std::string> tags;
+      for (auto& tag : latest.tags ())
+        tags.push_back (tag);
+
+      value = format ("{1}", tags[n - 1]);
+      return true;
+    }
+  }
+
+  return false;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 bool domGet (
   Database& database,
@@ -52,67 +129,7 @@ bool domGet (
       IntervalFilterFirstOf filtering {std::make_shared <IntervalFilterAllInRange> (Range {})};
       auto intervals = getTracked (database, rules, filtering);
 
-      // dom.active
-      if (pig.eos ())
-      {
-        value = !intervals.empty () && intervals.at (0).is_open () ? "1" : "0";
-        return true;
-      }
-
-      if (intervals.empty ())
-      {
-        return false;
-      }
-
-      auto latest = intervals.at (0);
-
-      // dom.active.start
-      if (pig.skipLiteral (".start") &&
-          latest.is_open ())
-      {
-        value = latest.start.toISOLocalExtended ();
-        return true;
-      }
-
-      // dom.active.duration
-      if (pig.skipLiteral (".duration") &&
-          latest.is_open ())
-      {
-        value = Duration (latest.total ()).formatISO ();
-        return true;
-      }
-
-      // dom.active.tag.count
-      if (pig.skipLiteral (".tag.count") &&
-          latest.is_open ())
-      {
-        value = format ("{1}", latest.tags ().size ());
-        return true;
-      }
-
-      // dom.active.json
-      if (pig.skipLiteral (".json") &&
-          latest.is_open ())
-      {
-        value = latest.json ();
-        return true;
-      }
-
-      // dom.active.tag.<N>
-      int n;
-      if (pig.skipLiteral (".tag.") &&
-          pig.getDigits (n))
-      {
-        if (1 <= n && n <= static_cast <int> (latest.tags ().size ()))
-        {
-          std::vector <std::string> tags;
-          for (auto& tag : latest.tags ())
-            tags.push_back (tag);
-
-          value = format ("{1}", tags[n - 1]);
-          return true;
-        }
-      }
+      return domGetActive (intervals.empty () ? Interval () : intervals.at (0), reference, value);
     }
 
     // dom.tracked.<...>
@@ -27,6 +27,7 @@
 #include <Datetime.h>
 #include <Duration.h>
 #include <IntervalFactory.h>
+#include <TagDictionary.h>
 #include <format.h>
 #include <iomanip>
 #include <map>
@@ -51,9 +52,10 @@ Color summaryIntervalColor (
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Select a color to represent the interval on a chart.
+// Select a color to represent the interval on a chart, from the ids of its
+// tags, blended in the order given.
 Color chartIntervalColor (
-  const std::set <std::string>& tags,
+  const std::vector <unsigned int>& tags,
   const std::map <std::string, Color>& tag_colors)
 {
   if (tags.empty ())
@@ -63,9 +65,9 @@ Color chartIntervalColor (
 
   Color c;
 
-  for (auto& tag : tags)
+  for (auto id : tags)
   {
-      c.blend (tag_colors.at (tag));
+      c.blend (tag_colors.at (TagDictionary::name (id)));
   }
 
   return c;
@@ -330,18 +332,18 @@ bool expandIntervalHint (
 //   {...}
 //   ]
 //
-std::string jsonFromIntervals (const std::vector <Interval>& intervals)
+std::string jsonFromIntervals (const IntervalColumns& intervals)
 {
   std::stringstream out;
 
   out << "[\n";
   int counter = 0;
-  for (auto& interval : intervals)
+  for (size_t i = 0; i < intervals.size (); ++i)
   {
     if (counter)
       out << ",\n";
 
-    out << interval.json ();
+    out << intervals.interval (i).json ();
     ++counter;
   }
 
@@ -377,17 +379,28 @@ Palette createPalette (const Rules& rules)
 std::map <std::string, Color> createTagColorMap (
   const Rules& rules,
   Palette& palette,
-  const std::vector <Interval>& intervals)
+  const IntervalColumns& intervals)
 {
   std::map <std::string, Color> mapping;
 
   // Add a color for intervals without tags
   mapping[""] = palette.next ();
 
-  for (auto& interval : intervals)
+  // Each distinct tag only needs to be looked up once.
+  std::vector <bool> seen (TagDictionary::size (), false);
+
+  for (size_t i = 0; i < intervals.size (); ++i)
   {
-    for (auto& tag : interval.tags ())
+    for (auto id : intervals.tagIds (i))
     {
+      if (seen[id])
+      {
+        continue;
+      }
+
+      seen[id] = true;
+
+      auto& tag = TagDictionary::name (id);
       std::string custom = "tags." + tag + ".color";
       if (rules.has (custom))
       {
@@ -24,6 +24,8 @@
 //
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <IntervalFactory.h>
+#include <StateFile.h>
 #include <cmake.h>
 #include <commands.h>
 #include <format.h>
@@ -45,6 +47,48 @@ bool lightweightVersionCheck (int argc, const char** argv)
   return false;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Answers 'timew get dom.active...', as run by shell prompts, from the state
+// file alone. Anything else, and anything the state file cannot answer,
+// including invalid references, is left to the full startup.
+bool lightweightDomGet (int argc, const char** argv)
+{
+  if (argc < 3 || std::string (argv[1]) != "get")
+    return false;
+
+  std::vector <std::string> latest;
+  std::vector <std::string> tags;
+  if (! StateFile::read (paths::dbDataDir (), paths::configFile (), latest, tags))
+    return false;
+
+  std::vector <std::string> results;
+  try
+  {
+    Interval interval;
+    if (! latest.empty ())
+    {
+      interval = IntervalFactory::fromSerialization (latest[0]);
+      interval.id = 1;
+    }
+
+    for (int i = 2; i < argc; ++i)
+    {
+      std::string value;
+      if (! domGetActive (interval, argv[i], value))
+        return false;
+
+      results.push_back (value);
+    }
+  }
+  catch (const std::string&)
+  {
+    return false;
+  }
+
+  std::cout << join (" ", results) << '\n';
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void initializeEntities (CLI& cli)
 {
@@ -85,6 +129,7 @@ void initializeEntities (CLI& cli)
   cli.entity ("extension", "month");
   cli.entity ("extension", "summary");
   cli.entity ("extension", "week");
+  cli.entity ("extension", "year");
 
   // Hint entities.
   cli.entity ("hint", ":all");
@@ -174,7 +219,16 @@ void initializeDataJournalAndRules (
   std::string dbDataDir = paths::dbDataDir ();
   journal.initialize (dbDataDir + "/undo.data", rules.getInteger ("journal.size"));
   // Initialize the database (no data read), but files are enumerated.
-  database.initialize (dbDataDir, journal);
+  database.initialize (dbDataDir, journal, rules.getBoolean ("ids.stable"));
+
+  // The state file can only stand in for the latest interval if nothing
+  // changes how it is shown.
+  auto configs = rules.imports ();
+  configs.insert (configs.begin (), paths::configFile ());
+  database.initializeState (configs,
+                            ! rules.getBoolean ("debug") &&
+                            rules.all ("exclusions.").empty () &&
+                            rules.all ("holidays.").empty ());
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -252,6 +306,7 @@ int dispatchCommand (
     else if (command == "undo")        status = CmdUndo          (     rules, database, journal            );
     else if (command == "untag")       status = CmdUntag         (cli, rules, database, journal            );
     else if (command == "week")        status = CmdChartWeek     (cli, rules, database                     );
+    else if (command == "year")        status = CmdChartYear     (cli, rules, database                     );
     else                               status = CmdReport        (cli, rules, database,          extensions);
   }
   else
@@ -47,6 +47,10 @@ int main (int argc, const char** argv)
   if (lightweightVersionCheck (argc, argv))
     return status;
 
+  // Prompts query the active interval often, which needs no full startup.
+  if (lightweightDomGet (argc, argv))
+    return status;
+
   try
   {
     // Timewarrior has special handling needs for times, such that a time that
@@ -89,6 +93,7 @@ int main (int argc, const char** argv)
     Extensions extensions;
     initializeExtensions (cli, rules, extensions);
     cli.analyze ();
+    resolveStableIds (cli, database, rules);
 
     // Dispatch to commands.
     status = dispatchCommand (cli, database, journal, rules, extensions);
@@ -32,28 +32,31 @@
 #include <Database.h>
 #include <Exclusion.h>
 #include <Extensions.h>
+#include <HolidayCalendar.h>
 #include <Interval.h>
+#include <IntervalColumns.h>
 #include <IntervalFilter.h>
 #include <Palette.h>
 #include <Rules.h>
 
 // data.cpp
-std::vector <Range>     getHolidays       (const Rules&);
+const HolidayCalendar&  getHolidays       (const Rules&);
 std::vector <Range>     getAllExclusions  (const Rules&, const Range&);
 std::vector <Range>     subset            (const Range&, const std::vector <Range>&);
 std::vector <Interval>  subset            (const Range&, const std::vector <Interval>&);
 void                    flattenDatabase   (Database&, const Rules&);
 std::vector <Interval>  flatten           (const Interval&, const std::vector <Range>&);
 std::vector <Range>     merge             (const std::vector <Range>&);
-std::vector <Range>     addRanges         (const Range&, const std::vector <Range>&, const std::vector <Range>&);
 std::vector <Range>     subtractRanges    (const std::vector <Range>&, const std::vector <Range>&);
 Range                   outerRange        (const std::vector <Interval>&);
 bool                    matchesRange      (const Interval&, const Range&);
 bool                    matchesFilter     (const Interval&, const Interval&);
 Interval                clip              (const Interval&, const Range&);
 std::vector <Interval>  getTracked        (Database&, const Rules&, IntervalFilter&);
+IntervalColumns         getTrackedColumns (Database&, const Rules&, IntervalFilter&);
 std::vector <Range>     getUntracked      (Database&, const Rules&, Interval&);
 Interval                getLatestInterval (Database&);
+void                    resolveStableIds  (CLI&, Database&, const Rules&);
 Range                   getFullDay        (const Datetime&);
 
 // validate.cpp
@@ -62,6 +65,7 @@ bool validate (const CLI& cli, const Rules& rules, Database&, Interval&);
 
 // init.cpp
 bool lightweightVersionCheck (int, const char**);
+bool lightweightDomGet (int, const char**);
 void initializeEntities (CLI&);
 void initializeDataJournalAndRules (const CLI&, Database&, Journal&, Rules&);
 void initializeExtensions (CLI&, const Rules&, Extensions&);
@@ -69,13 +73,13 @@ int dispatchCommand (const CLI&, Database&, Journal&, Rules&, const Extensions&)
 
 // helper.cpp
 Color summaryIntervalColor (const Rules&, const std::set <std::string>&);
-Color chartIntervalColor (const std::set <std::string>&, const std::map <std::string, Color>&);
+Color chartIntervalColor (const std::vector <unsigned int>&, const std::map <std::string, Color>&);
 Color tagColor (const Rules&, const std::string&);
 std::string intervalSummarize (const Rules&, const Interval&);
 bool expandIntervalHint (const std::string&, Range&);
-std::string jsonFromIntervals (const std::vector <Interval>&);
+std::string jsonFromIntervals (const IntervalColumns&);
 Palette createPalette (const Rules&);
-std::map <std::string, Color> createTagColorMap (const Rules&, Palette&, const std::vector <Interval>&);
+std::map <std::string, Color> createTagColorMap (const Rules&, Palette&, const IntervalColumns&);
 int quantizeToNMinutes (int, int);
 
 bool findHint (const CLI&, const std::string&);
@@ -93,8 +97,14 @@ std::string quoteIfNeeded (const std::string&);
 std::string join(const std::string& glue, const std::set <std::string>& array);
 std::string joinQuotedIfNeeded(const std::string& glue, const std::set <std::string>& array);
 std::string joinQuotedIfNeeded(const std::string& glue, const std::vector <std::string>& array);
+std::string formatStableId (uint64_t);
+uint64_t parseStableId (std::string_view);
+int daysFromCivil (int, int, int);
+void civilFromDays (int, int&, int&, int&);
+bool parseUtcTimestamp (std::string_view, time_t&);
 
 // dom.cpp
 bool domGet (Database&, Interval&, const Rules&, const std::string&, std::string&);
+bool domGetActive (const Interval&, const std::string&, std::string&);
 
 #endif
@@ -141,3 +141,123 @@ std::string joinQuotedIfNeeded(const std::string& glue, const std::vector <std::
 }
 
 ////////////////////////////////////////////////////////////////////////////////
+// Stable ids of intervals are written as 16 lowercase hex digits.
+std::string formatStableId (uint64_t uid)
+{
+  static const char digits[] = "0123456789abcdef";
+
+  std::string output (16, '0');
+  for (int i = 15; i >= 0; --i)
+  {
+    output[i] = digits[uid & 0xf];
+    uid >>= 4;
+  }
+
+  return output;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Returns 0, which is not a valid stable id, unless the input is exactly 16
+// lowercase hex digits.
+uint64_t parseStableId (std::string_view input)
+{
+  if (input.size () != 16)
+  {
+    return 0;
+  }
+
+  uint64_t uid = 0;
+  for (auto c : input)
+  {
+    if (c >= '0' && c <= '9')
+    {
+      uid = (uid << 4) | (c - '0');
+    }
+    else if (c >= 'a' && c <= 'f')
+    {
+      uid = (uid << 4) | (c - 'a' + 10);
+    }
+    else
+    {
+      return 0;
+    }
+  }
+
+  return uid;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The number of days from 1970-01-01 to the given date of the proleptic
+// Gregorian calendar, so that days can be counted without mktime.
+int daysFromCivil (int y, int m, int d)
+{
+  y -= m <= 2;
+  const int era = (y >= 0 ? y : y - 399) / 400;
+  const int yoe = y - era * 400;
+  const int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The date of the given number of days from 1970-01-01.
+void civilFromDays (int days, int& y, int& m, int& d)
+{
+  days += 719468;
+  const int era = (days >= 0 ? days : days - 146096) / 146097;
+  const int doe = days - era * 146097;
+  const int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  const int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const int mp = (5 * doy + 2) / 153;
+  d = doy - (153 * mp + 2) / 5 + 1;
+  m = mp < 10 ? mp + 3 : mp - 9;
+  y = yoe + era * 400 + (m <= 2);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Decodes the 'YYYYMMDDTHHMMSSZ' form Interval::serialize writes, without
+// going through Datetime's parser.  Returns false for anything else, which
+// includes dates that do not exist, so the caller can leave those to Datetime.
+bool parseUtcTimestamp (std::string_view input, time_t& epoch)
+{
+  if (input.size () != 16 || input[8] != 'T' || input[15] != 'Z')
+    return false;
+
+  auto number = [&input] (std::string_view::size_type start, std::string_view::size_type length, int& value)
+  {
+    value = 0;
+    for (auto i = start; i < start + length; ++i)
+    {
+      if (input[i] < '0' || input[i] > '9')
+        return false;
+
+      value = value * 10 + (input[i] - '0');
+    }
+
+    return true;
+  };
+
+  int y, m, d, hh, mm, ss;
+  if (! number (0, 4, y)   ||
+      ! number (4, 2, m)   ||
+      ! number (6, 2, d)   ||
+      ! number (9, 2, hh)  ||
+      ! number (11, 2, mm) ||
+      ! number (13, 2, ss))
+    return false;
+
+  if (y < 1970 || m < 1 || m > 12 || d < 1 || hh > 23 || mm > 59 || ss > 59)
+    return false;
+
+  // Rejects days past the end of the month, such as February 30th.
+  auto days = daysFromCivil (y, m, d);
+  int check_y, check_m, check_d;
+  civilFromDays (days, check_y, check_m, check_d);
+  if (check_m != m || check_d != d)
+    return false;
+
+  epoch = static_cast <time_t> (days) * 86400 + hh * 3600 + mm * 60 + ss;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
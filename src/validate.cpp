@@ -105,7 +105,7 @@ static bool autoAdjust (
 
   if (interval.is_open () && latest.encloses (interval))
   {
-    if (latest.tags () == interval.tags ())
+    if (latest.tagIds () == interval.tagIds ())
     {
       // If the new interval tags match those of the currently open interval,
       // then do nothing - the tags are already being tracked.
@@ -154,6 +154,7 @@ static bool autoAdjust (
   else
   {
     // implement overwrite resolution, i.e. the new interval overwrites existing intervals
+    Database::WriteBatch batch;
     for (auto& overlap : overlaps)
     {
       bool start_within_overlap = interval.startsWithin (overlap);
@@ -167,11 +168,11 @@ static bool autoAdjust (
 
         if (modified.is_empty ())
         {
-          database.deleteInterval (overlap);
+          batch.deleteInterval (overlap);
         }
         else
         {
-          database.modifyInterval (overlap, modified, verbose);
+          batch.modifyInterval (overlap, modified);
         }
       }
       else if (!start_within_overlap && end_within_overlap)
@@ -182,17 +183,17 @@ static bool autoAdjust (
 
         if (modified.is_empty ())
         {
-          database.deleteInterval (overlap);
+          batch.deleteInterval (overlap);
         }
         else
         {
-          database.modifyInterval (overlap, modified, verbose);
+          batch.modifyInterval (overlap, modified);
         }
       }
       else if (!start_within_overlap && !end_within_overlap)
       {
         // new interval encloses old interval
-        database.deleteInterval (overlap);
+        batch.deleteInterval (overlap);
       }
       else
       {
@@ -205,19 +206,21 @@ static bool autoAdjust (
 
         if (split1.is_empty ())
         {
-          database.deleteInterval (overlap);
+          batch.deleteInterval (overlap);
         }
         else
         {
-          database.modifyInterval (overlap, split1, verbose);
+          batch.modifyInterval (overlap, split1);
         }
 
         if (! split2.is_empty ())
         {
-          database.addInterval (split2, verbose);
+          batch.addInterval (split2);
         }
       }
     }
+
+    database.apply (batch, verbose);
   }
   return true;
 }
@@ -26,8 +26,10 @@
 
 #include <AtomicFile.h>
 #include <FS.h>
+#include <MappedFile.h>
 #include <TempDir.h>
 #include <cassert>
+#include <cstdio>
 #include <iostream>
 #include <memory>
 #include <sstream>
@@ -106,6 +108,20 @@ const std::vector <const char *> FIU::test_points {
 std::stringstream FIU::cbuffer;
 int FIU::external_cb_was_called = 0;
 
+// Lets the first pwrite pass, which saves the rollback record in
+// finalize_all, and fails the ones that write the new end of the file.
+static int pwrite_calls = 0;
+
+static int fail_after_first_pwrite (const char *name, int *failnum,
+                                    void **failinfo, unsigned int *flags)
+{
+  (void)name;
+  (void)flags;
+
+  *failinfo = (void *) EIO;
+  return ++pwrite_calls > 1 ? *failnum : 0;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // Since AtomicFile is primarily for keeping the database consistent in the
 // presence of filesystem errors, these tests use libfiu to ensure that
@@ -124,20 +140,44 @@ int fiu_test (UnitTest& t)
   try { FIU fiu; AtomicFile::reset (); AtomicFile::finalize_all ();  t.pass ("AtomicFileTest: AtomicFile::reset clears failure state"); }
   catch (...) {                                                      t.fail ("AtomicFileTest: AtomicFile::reset clears failure state"); }
 
+  std::string contents;
+
   File::write ("test.txt", "line1\n");
   {
     AtomicFile file ("test.txt");
     try { FIU fiu; file.append ("append1\n");                        t.fail ("AtomicFileTest: AtomicFile::append throws on error"); }
     catch (...) {                                                    t.pass ("AtomicFileTest: AtomicFile::append throws on error"); }
 
-    std::string contents {"should-not-see-this"};
+    contents = "should-not-see-this";
     file.read (contents);
-    t.is (contents, "", "AtomicFile::append did not partially fill the file.");
+    t.ok (contents.find ("append1") == std::string::npos, "AtomicFile::append did not partially fill the file.");
   }
 
   try { FIU fiu; AtomicFile::finalize_all ();                       t.fail ("AtomicFileTest: AtomicFile::append failures prevent finalization"); }
   catch (...) {                                                     t.pass ("AtomicFileTest: AtomicFile::append failures prevent finalization"); }
 
+  File::read ("test.txt", contents);
+  t.is (contents, "line1\n", "AtomicFileTest: AtomicFile::append failures leave the file unchanged");
+  AtomicFile::reset ();
+
+  // An in-place update of an existing file that fails in finalize_all, after
+  // its rollback record was saved.
+  File::write ("tail.txt", "line1\nline2\n");
+  {
+    AtomicFile file ("tail.txt");
+    file.replace_tail (6, "line2 changed\n");
+  }
+
+  fiu_enable_external ("posix/io/rw/pwrite", 1, NULL, 0, fail_after_first_pwrite);
+  try { AtomicFile::finalize_all ();                                t.fail ("AtomicFileTest: AtomicFile::replace_tail failures throw on finalization"); }
+  catch (...) {                                                     t.pass ("AtomicFileTest: AtomicFile::replace_tail failures throw on finalization"); }
+  fiu_disable ("posix/io/rw/pwrite");
+
+  File::read ("tail.txt", contents);
+  t.is (contents, "line1\nline2\n", "AtomicFileTest: AtomicFile::replace_tail failures restore the file");
+  t.is (Path ("tail.txt.rollback").exists (), false, "AtomicFileTest: AtomicFile::replace_tail failures remove the rollback record");
+  AtomicFile::reset ();
+
   return 0;
 }
 #else
@@ -157,6 +197,10 @@ int fiu_test (UnitTest& t)
   t.skip ("AtomicFileTest: AtomicFile::append throws on error");
   t.skip ("AtomicFileTest: AtomicFile::append did not partially fill the file.");
   t.skip ("AtomicFileTest: AtomicFile::append failures prevent finalization");
+  t.skip ("AtomicFileTest: AtomicFile::append failures leave the file unchanged");
+  t.skip ("AtomicFileTest: AtomicFile::replace_tail failures throw on finalization");
+  t.skip ("AtomicFileTest: AtomicFile::replace_tail failures restore the file");
+  t.skip ("AtomicFileTest: AtomicFile::replace_tail failures remove the rollback record");
   return 0;
 }
 #endif // FIU_ENABLE
@@ -415,6 +459,95 @@ int test (UnitTest& t)
     t.is (test.exists (), false, "AtomicFileTest: File is removed after finalize");
   }
 
+  {
+    tempDir.clear ();
+    Path test ("tail.txt");
+    File::write (test, "line1\nline2\n");
+    AtomicFile file (test);
+    file.replace_tail (6, "line2 changed\nline3\n");
+    File::read (test, contents);
+    t.is (contents, "line1\nline2\n", "AtomicFileTest: Tail not replaced before finalize");
+    AtomicFile::finalize_all ();
+    File::read (test, contents);
+    t.is (contents, "line1\nline2 changed\nline3\n", "AtomicFileTest: Tail replaced after finalize");
+    t.is (Path ("tail.txt.rollback").exists (), false, "AtomicFileTest: No rollback record after finalize");
+  }
+
+  {
+    tempDir.clear ();
+    Path test ("copy.txt");
+    File::write (test, "line1\nline2\n");
+    MappedFile mapping;
+    mapping.open (test);
+    AtomicFile file (test);
+    t.ok (file.copy_with_tail (6, "line2 changed\n", mapping.content ().size (), mapping.mtime ()), "AtomicFileTest: Tail copied onto the mapped file");
+    File::read (test, contents);
+    t.is (contents, "line1\nline2\n", "AtomicFileTest: Copied tail not written before finalize");
+    AtomicFile::finalize_all ();
+    File::read (test, contents);
+    t.is (contents, "line1\nline2 changed\n", "AtomicFileTest: Copied tail replaced after finalize");
+    t.is (std::string (mapping.content ()), "line1\nline2\n", "AtomicFileTest: Mapping of the replaced file is unchanged");
+  }
+
+  {
+    // The offset belongs to the mapped file, so another file renamed over it
+    // in the meantime is not joined to the tail.
+    tempDir.clear ();
+    Path test ("copy.txt");
+    File::write (test, "line1\nline2\n");
+    MappedFile mapping;
+    mapping.open (test);
+    File::write ("other.txt", "other1\nother2\nother3\n");
+    std::rename ("other.txt", "copy.txt");
+    AtomicFile file (test);
+    t.notok (file.copy_with_tail (6, "line2 changed\n", mapping.content ().size (), mapping.mtime ()), "AtomicFileTest: Tail not copied onto a replaced file");
+    AtomicFile::finalize_all ();
+    File::read (test, contents);
+    t.is (contents, "other1\nother2\nother3\n", "AtomicFileTest: Replaced file left unchanged");
+  }
+
+  {
+    // An update that was interrupted after the rollback record was saved.
+    tempDir.clear ();
+    Path test ("tail.txt");
+    File::write (test, "line1\nline2 cha");
+    File::write ("tail.txt.rollback", "12\nline2\n");
+    t.is (AtomicFile::recover (test), true, "AtomicFileTest: Interrupted update found");
+    File::read (test, contents);
+    t.is (contents, "line1\nline2\n", "AtomicFileTest: Interrupted update rolled back");
+    t.is (Path ("tail.txt.rollback").exists (), false, "AtomicFileTest: Rollback record removed");
+    t.is (AtomicFile::recover (test), false, "AtomicFileTest: Nothing to recover");
+  }
+
+  {
+    tempDir.clear ();
+    Path test ("log.txt");
+    File::write (test, "line1\n");
+    AtomicFile file (test);
+    file.append ("line2\n");
+    file.append ("line3\n");
+    AtomicFile::read (test, contents);
+    t.is (contents, "line1\nline2\nline3\n", "AtomicFileTest: Appended data read before finalize");
+    t.is (file.size (), (size_t) 18, "AtomicFileTest: Size includes appended data");
+    File::read (test, contents);
+    t.is (contents, "line1\n", "AtomicFileTest: Append not written before finalize");
+    AtomicFile::finalize_all ();
+    File::read (test, contents);
+    t.is (contents, "line1\nline2\nline3\n", "AtomicFileTest: Appended data written after finalize");
+    t.is (Path ("log.txt.rollback").exists (), false, "AtomicFileTest: No rollback record after append");
+  }
+
+  {
+    // An append that was interrupted after the rollback record was saved.
+    tempDir.clear ();
+    Path test ("log.txt");
+    File::write (test, "line1\nline2\nli");
+    File::write ("log.txt.rollback", "6\n");
+    t.is (AtomicFile::recover (test), true, "AtomicFileTest: Interrupted append found");
+    File::read (test, contents);
+    t.is (contents, "line1\n", "AtomicFileTest: Interrupted append cut off");
+  }
+
   tempDir.clear();
   test_symlink(t);
 
@@ -423,7 +556,7 @@ int test (UnitTest& t)
 
 int main (int, char**)
 {
-  UnitTest t (22);
+  UnitTest t (46);
   try
   {
     int ret = test (t);
@@ -24,14 +24,18 @@
 //
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <AtomicFile.h>
 #include <Datafile.h>
+#include <FS.h>
 #include <Interval.h>
+#include <IntervalFactory.h>
 #include <TempDir.h>
+#include <cstdio>
 #include <test.h>
 
 int main ()
 {
-  UnitTest t (2);
+  UnitTest t (20);
   TempDir tempDir;
 
   try
@@ -52,6 +56,132 @@ int main ()
     message = "Datafile::deleteInterval does not throw on success";
     try { df.deleteInterval (interval); t.pass (message); }
     catch (...) { t.fail (message); }
+
+    // The sidecar index is built on first read and must always agree with the
+    // text of the data file.
+    const std::string first  = "inc 20200601T010000Z - 20200601T020000Z # bar foo # \"note\"";
+    const std::string second = "inc 20200602T010000Z - 20200602T020000Z # foo";
+    File::write ("2020-07.data", first + '\n' + second + '\n');
+
+    Datafile indexed;
+    indexed.initialize ("2020-07.data");
+    t.is (indexed.count (), (size_t) 2, "Datafile::count returns the number of lines");
+    t.ok (indexed.interval (0) == IntervalFactory::fromSerialization (first), "Datafile::interval restores tags and annotation");
+    t.ok (Path ("2020-07.idx").exists (), "Datafile writes the index on first read");
+
+    Datafile reloaded;
+    reloaded.initialize ("2020-07.data");
+    t.ok (reloaded.interval (1) == IntervalFactory::fromSerialization (second), "Datafile::interval reads from an existing index");
+
+    const std::string replaced = "inc 20200603T010000Z - 20200603T023000Z # baz";
+    File::write ("2020-07.data", replaced + '\n');
+
+    Datafile stale;
+    stale.initialize ("2020-07.data");
+    t.is (stale.count (), (size_t) 1, "Datafile rebuilds a stale index");
+    t.ok (stale.interval (0) == IntervalFactory::fromSerialization (replaced), "Datafile::interval ignores a stale index");
+
+    // A file replaced by another process after it was read, but before its
+    // index was written, must not have the index of the old content accepted.
+    const std::string read_line = "inc 20200501T010000Z - 20200501T020000Z # foo";
+    const std::string new_line  = "inc 20200502T010000Z - 20200502T020000Z # foo bar";
+    File::write ("2020-05.data", read_line + '\n');
+
+    Datafile raced;
+    raced.initialize ("2020-05.data");
+    raced.allLines ();
+    File::write ("2020-05.new", read_line + '\n' + new_line + '\n');
+    std::rename ("2020-05.new", "2020-05.data");
+    t.is (raced.count (), (size_t) 1, "Datafile indexes the lines it read");
+
+    Datafile after;
+    after.initialize ("2020-05.data");
+    t.is (after.count (), (size_t) 2, "Datafile rejects an index of a file replaced while indexing");
+
+    // Lines read from the file are views into the mapped file, and lines added
+    // in the session are owned by the Datafile.
+    t.is (std::string (stale.allLines ()[0]), replaced, "Datafile::allLines returns lines of the mapped file");
+
+    Interval added {Datetime ("2020-07-04T01:00:00"), Datetime ("2020-07-04T02:00:00")};
+    stale.addInterval (added);
+    t.is (std::string (stale.allLines ()[1]), added.serialize (), "Datafile::addInterval adds an owned line");
+
+    message = "Datafile::deleteInterval finds a line of the mapped file";
+    try { stale.deleteInterval (IntervalFactory::fromSerialization (replaced)); t.pass (message); }
+    catch (...) { t.fail (message); }
+
+    // Replacing the newest line only writes the end of the file anew.
+    const std::string older = "inc 20200801T010000Z - 20200801T020000Z # foo";
+    const std::string open  = "inc 20200802T010000Z # bar";
+    File::write ("2020-08.data", older + '\n' + open + '\n');
+
+    Datafile appended;
+    appended.initialize ("2020-08.data");
+    Interval stopped = IntervalFactory::fromSerialization (open);
+    appended.deleteInterval (stopped);
+    stopped.end = Datetime ("2020-08-02T03:00:00");
+    appended.addInterval (stopped);
+    appended.commit ();
+    AtomicFile::finalize_all ();
+
+    std::string content;
+    File::read ("2020-08.data", content);
+    t.is (content, older + '\n' + stopped.serialize () + '\n', "Datafile::commit replaces the newest line");
+
+    // Several intervals are deleted and added in one update.
+    const std::string removed = "inc 20200901T010000Z - 20200901T020000Z # foo";
+    const std::string kept    = "inc 20200902T010000Z - 20200902T020000Z # bar";
+    const std::string changed = "inc 20200903T010000Z - 20200903T020000Z # baz";
+    File::write ("2020-09.data", removed + '\n' + kept + '\n' + changed + '\n');
+
+    Datafile updated;
+    updated.initialize ("2020-09.data");
+    Interval moved = IntervalFactory::fromSerialization (changed);
+    moved.tag ("moved");
+    updated.update ({removed, changed}, {moved});
+    updated.commit ();
+    AtomicFile::finalize_all ();
+
+    File::read ("2020-09.data", content);
+    t.is (content, kept + '\n' + moved.serialize () + '\n', "Datafile::update deletes and adds intervals");
+
+    // Identical lines are deleted one at a time, and added lines can be
+    // deleted before the file is written.
+    const std::string twice = "inc 20201001T010000Z - 20201001T020000Z # foo";
+    File::write ("2020-10.data", twice + '\n' + twice + '\n');
+
+    Datafile duplicates;
+    duplicates.initialize ("2020-10.data");
+    Interval longer = IntervalFactory::fromSerialization (twice);
+    longer.end = Datetime ("2020-10-01T03:00:00");
+    duplicates.addInterval (longer);
+    duplicates.deleteInterval (IntervalFactory::fromSerialization (twice));
+    duplicates.deleteInterval (longer);
+    t.is (duplicates.allLines ().size (), (size_t) 1, "Datafile::deleteInterval removes one of identical lines");
+
+    duplicates.deleteInterval (IntervalFactory::fromSerialization (twice));
+    t.is (duplicates.allLines ().size (), (size_t) 0, "Datafile::deleteInterval removes the last line");
+
+    // The last line is read from the end of the file, across several blocks
+    // if need be.
+    std::string many;
+    for (int i = 0; i < 200; ++i)
+      many += "inc 20201101T010000Z - 20201101T020000Z # tag" + std::to_string (i) + '\n';
+    const std::string last = "inc 20201130T010000Z # " + std::string (5000, 'x');
+    File::write ("2020-11.data", many + last + '\n');
+
+    Datafile tailed;
+    tailed.initialize ("2020-11.data");
+    t.is (tailed.lastLine (), last, "Datafile::lastLine reads a line longer than a block");
+
+    File::write ("2020-12.data", many + "\n\n");
+    Datafile trailing;
+    trailing.initialize ("2020-12.data");
+    t.is (trailing.lastLine (), std::string ("inc 20201101T010000Z - 20201101T020000Z # tag199"), "Datafile::lastLine skips empty lines");
+
+    message = "Datafile::update throws for a missing interval";
+    try { updated.update ({removed}, {}); t.fail (message); }
+    catch (...) { t.pass (message); }
   }
   catch (...)
   {
@@ -0,0 +1,105 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <DayBuckets.h>
+#include <test.h>
+
+////////////////////////////////////////////////////////////////////////////////
+static Range day (int d)
+{
+  return Range (Datetime (2020, 6, d, 0, 0, 0), Datetime (2020, 6, d + 1, 0, 0, 0));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static Range hours (int d, int from, int to)
+{
+  return Range (Datetime (2020, 6, d, from, 0, 0), Datetime (2020, 6, d, to, 0, 0));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int main (int, char**)
+{
+  UnitTest t (15);
+
+  std::vector <Range> days {day (1), day (2), day (3), day (4)};
+
+  // [0] within day 1, [1] from day 1 into day 3, [2] zero-width at the start
+  //     of day 2, [3] ends at the start of day 3, [4] open from day 3.
+  Range open;
+  open.start = Datetime (2020, 6, 3, 12, 0, 0);
+
+  std::vector <Range> ranges {
+    hours (1, 8, 9),
+    Range (Datetime (2020, 6, 1, 22, 0, 0), Datetime (2020, 6, 3, 2, 0, 0)),
+    hours (2, 0, 0),
+    Range (Datetime (2020, 6, 2, 12, 0, 0), Datetime (2020, 6, 3, 0, 0, 0)),
+    open
+  };
+
+  DayBuckets buckets (ranges, days);
+  t.is (buckets.size (), (size_t) 4, "DayBuckets holds a bucket for each day");
+
+  auto first = buckets.bucket (0);
+  t.is (first.size (), (size_t) 2, "DayBuckets day 1 -> 2 intervals");
+  t.is (first.first[0], (size_t) 0, "DayBuckets day 1 [0] -> interval 0");
+  t.is (first.first[1], (size_t) 1, "DayBuckets day 1 [1] -> interval 1, which crosses midnight");
+
+  auto second = buckets.bucket (1);
+  t.is (second.size (), (size_t) 3, "DayBuckets day 2 -> 3 intervals");
+  t.is (second.first[0], (size_t) 1, "DayBuckets day 2 [0] -> interval 1");
+  t.is (second.first[1], (size_t) 2, "DayBuckets day 2 [1] -> interval 2, zero-width at midnight");
+  t.is (second.first[2], (size_t) 3, "DayBuckets day 2 [2] -> interval 3");
+
+  auto third = buckets.bucket (2);
+  t.is (third.size (), (size_t) 2, "DayBuckets day 3 -> 2 intervals, not the one ending at midnight");
+  t.is (third.first[0], (size_t) 1, "DayBuckets day 3 [0] -> interval 1");
+  t.is (third.first[1], (size_t) 4, "DayBuckets day 3 [1] -> interval 4");
+
+  auto fourth = buckets.bucket (3);
+  t.is (fourth.size (), (size_t) 1, "DayBuckets day 4 -> 1 interval");
+  t.is (fourth.first[0], (size_t) 4, "DayBuckets day 4 [0] -> the open interval");
+
+  // Each bucket agrees with Range::intersects.
+  bool same = true;
+  for (size_t d = 0; d < days.size (); ++d)
+  {
+    std::vector <size_t> expected;
+    for (size_t i = 0; i < ranges.size (); ++i)
+      if (days[d].intersects (ranges[i]))
+        expected.push_back (i);
+
+    auto bucket = buckets.bucket (d);
+    same = same && std::vector <size_t> (bucket.begin (), bucket.end ()) == expected;
+  }
+  t.ok (same, "DayBuckets agrees with Range::intersects");
+
+  DayBuckets none (std::vector <Range> {}, days);
+  t.ok (none.bucket (2).empty (), "DayBuckets without intervals -> empty buckets");
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,89 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <HolidayCalendar.h>
+#include <test.h>
+
+////////////////////////////////////////////////////////////////////////////////
+int main (int, char**)
+{
+  UnitTest t (16);
+
+  Rules rules;
+  rules.set ("holidays.en-US.2016_12_25", "Christmas");
+  rules.set ("holidays.de-DE.2016_12_25", "Weihnachten");
+  rules.set ("holidays.de-DE.2016_12_26", "Zweiter Weihnachtstag");
+  rules.set ("holidays.en-US.2016_07_04", "Independence Day");
+  rules.set ("holidays.en-US.2017_01_01", "New Year's Day");
+
+  HolidayCalendar calendar (rules);
+  t.is ((int) calendar.size (), 5, "HolidayCalendar holds every holiday");
+
+  t.ok (calendar.contains (Datetime (2016, 7, 4, 12, 0, 0)),    "HolidayCalendar contains 2016-07-04 noon");
+  t.ok (calendar.contains (Datetime (2016, 12, 26)),            "HolidayCalendar contains 2016-12-26");
+  t.notok (calendar.contains (Datetime (2016, 12, 24, 23, 59, 59)), "HolidayCalendar does not contain 2016-12-24");
+  t.notok (calendar.contains (Datetime (2017, 1, 2)),           "HolidayCalendar does not contain 2017-01-02");
+
+  // Holidays on the same day keep the order of their names.
+  auto slice = calendar.slice (Range (Datetime (2016, 12, 1), Datetime (2017, 1, 1)));
+  t.is ((int) (slice.second - slice.first), 3, "HolidayCalendar::slice December 2016 -> 3 holidays");
+  t.is (slice.first->locale, "de-DE", "HolidayCalendar::slice [0] de-DE");
+  t.is (slice.first->name, "Weihnachten", "HolidayCalendar::slice [0] Weihnachten");
+  t.is (HolidayCalendar::date ((slice.first + 2)->day), "2016-12-26", "HolidayCalendar::slice [2] 2016-12-26");
+
+  slice = calendar.slice (Range (Datetime (2016, 12, 26, 8, 0, 0), Datetime (2016, 12, 26, 9, 0, 0)));
+  t.is ((int) (slice.second - slice.first), 1, "HolidayCalendar::slice within a day -> 1 holiday");
+
+  Range open;
+  open.start = Datetime (2016, 12, 26);
+  slice = calendar.slice (open);
+  t.is ((int) (slice.second - slice.first), 2, "HolidayCalendar::slice open range -> 2 holidays");
+
+  slice = calendar.slice (Range ());
+  t.ok (slice.first == slice.second, "HolidayCalendar::slice unstarted range -> no holidays");
+
+  auto ranges = calendar.ranges (Range (Datetime (2016, 12, 1), Datetime (2017, 1, 1)));
+  t.is ((int) ranges.size (), 2, "HolidayCalendar::ranges December 2016 -> 2 days");
+  t.ok (ranges[0] == Range (Datetime (2016, 12, 25), Datetime (2016, 12, 26)), "HolidayCalendar::ranges [0] 2016-12-25");
+
+  Rules invalid;
+  invalid.set ("holidays.en-US.2016_02_30", "Nonesuch");
+  try
+  {
+    HolidayCalendar nonesuch (invalid);
+    t.fail ("HolidayCalendar rejects 2016_02_30");
+  }
+  catch (const std::string&)
+  {
+    t.pass ("HolidayCalendar rejects 2016_02_30");
+  }
+
+  t.is (HolidayCalendar::dayOf (Datetime (1970, 1, 2)), 1, "HolidayCalendar::dayOf 1970-01-02 -> 1");
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,66 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <IntervalColumns.h>
+#include <IntervalFactory.h>
+#include <test.h>
+
+////////////////////////////////////////////////////////////////////////////////
+int main (int, char**)
+{
+  UnitTest t (10);
+
+  const std::string first  = "inc 20200601T080000Z - 20200601T090000Z # bar foo # \"note\"";
+  const std::string second = "inc 20200601T100000Z # baz";
+
+  Interval one = IntervalFactory::fromSerialization (first);
+  one.id = 2;
+  Interval two = IntervalFactory::fromSerialization (second);
+  two.id = 1;
+
+  IntervalColumns columns;
+  t.ok (columns.empty (), "IntervalColumns is empty by default");
+
+  columns.add (two);
+  columns.add (one);
+  columns.reverse ();
+
+  t.is (columns.size (), (size_t) 2, "IntervalColumns holds two intervals");
+  t.is (columns.id (0), 2, "IntervalColumns::reverse reverses ids");
+  t.is ((int) columns.tagIds (0).size (), 2, "IntervalColumns::tagIds of the first interval");
+  t.is (std::string (columns.annotation (0)), "note", "IntervalColumns::annotation of the first interval");
+  t.ok (columns.end (1) == 0, "IntervalColumns::end is zero for an open interval");
+  t.ok (columns.interval (0) == one, "IntervalColumns::interval restores the first interval");
+  t.ok (columns.interval (1) == two, "IntervalColumns::interval restores the second interval");
+
+  Range morning {Datetime ("2020-06-01T07:00:00Z"), Datetime ("2020-06-01T08:30:00Z")};
+  t.ok (columns.overlaps (0, morning), "IntervalColumns::overlaps positive");
+  t.notok (columns.overlaps (1, morning), "IntervalColumns::overlaps negative");
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,199 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <IntervalFactory.h>
+#include <test.h>
+#include <timew.h>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// Parses the line with the Lexer-based parser, returning the error on failure.
+static bool lexerParse (const std::string& line, Interval& interval, std::string& error)
+{
+  try
+  {
+    interval = IntervalFactory::fromSerializationLexer (line);
+    return true;
+  }
+  catch (const std::string& e)
+  {
+    error = e;
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The fast parser must either decline a line, or agree with the Lexer-based
+// parser on the resulting interval or on the error.
+static bool agree (const std::string& line)
+{
+  Interval expected;
+  std::string expected_error;
+  bool expected_ok = lexerParse (line, expected, expected_error);
+
+  Interval actual;
+  try
+  {
+    if (! IntervalFactory::fromSerializationFast (line, actual))
+      return true;
+  }
+  catch (const std::string& e)
+  {
+    return ! expected_ok && e == expected_error;
+  }
+
+  return expected_ok && actual == expected;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int main (int, char**)
+{
+  // Lines as written by Interval::serialize, which must take the fast path.
+  const std::vector <std::string> plain {
+    "inc",
+    "inc # foo",
+    "inc # bar foo",
+    "inc # # \"this is an annotation\"",
+    "inc # foo # \"this is an annotation\"",
+    "inc 19700101T000001Z",
+    "inc 19700101T000001Z # bar foo",
+    "inc 19700101T000001Z - 19700101T000002Z",
+    "inc 19700101T000001Z - 19700101T000002Z # bar foo",
+    "inc 19700101T000001Z - 19700101T000002Z # \"Trans-Europe Express\" bar foo",
+    "inc 19700101T000001Z - 19700101T000002Z # \"Trans-Europe Express\" bar foo # \"this is an annotation\"",
+    "inc 20160101T080000Z - 20160101T090000Z # \"it's a tag\" 123 # \"\"",
+    "inc 19700101T000001Z ~00000000000000ff",
+    "inc 19700101T000001Z - 19700101T000002Z # bar foo # \"annotation\" ~0123456789abcdef",
+  };
+
+  // Everything else, including malformed lines and lines the fast parser
+  // leaves to the Lexer.
+  std::vector <std::string> corpus {
+    "",
+    " ",
+    "inc ",
+    "  inc  #  foo  ",
+    "exc monday <8:00",
+    "\"inc\" # foo",
+    "inc #",
+    "inc # #",
+    "inc # foo #",
+    "inc # foo # bar baz",
+    "inc # foo # \"bar\" \"baz\"",
+    "inc 19700101T000001Z -",
+    "inc 19700101T000001Z - #",
+    "inc 19700101T000001Z 19700101T000002Z # foo",
+    "inc - 19700101T000002Z # foo",
+    "inc 19700101T000001Z - 19700101T000002Z - # foo",
+    "inc 19700101T000001Z # foo # annotation # with hashes",
+    "inc # \"#\" foo",
+    "inc # \"foo bar\"baz",
+    "inc # \"unterminated",
+    "inc # \"with \\\"escaped\\\" quotes\"",
+    "inc # \"with U+0041 escape\"",
+    "inc # foo_bar foo-bar foo.bar foo:bar",
+    "inc # -foo #bar",
+    "inc # 1.5 1e5 0123 12e3x",
+    "inc # f\xc3\xbc\xc3\x9f # \"gr\xc3\xbc\xc3\x9f\"",
+    "inc\t#\tfoo",
+    "inc # foo\r",
+    "inc # 'single quoted'",
+    "inc # foo ~0123456789ABCDEF",
+    "inc # foo ~0000000000000000",
+    "inc # foo ~0123",
+    "inc 20160229T235959Z - 20160301T000000Z # leap",
+    "inc 2016-01-01T08:00 # foo",
+  };
+
+  // More tokens than the fast parser holds.
+  std::string many = "inc #";
+  for (int i = 0; i < 100; ++i)
+    many += " tag" + std::to_string (i);
+  corpus.push_back (many);
+
+  corpus.insert (corpus.end (), plain.begin (), plain.end ());
+
+  // Timestamps the direct decoder must read exactly as Datetime does.
+  const std::vector <std::string> decoded {
+    "19700101T000000Z",
+    "19700101T000001Z",
+    "20160229T235959Z",
+    "20160301T000000Z",
+    "20201231T120000Z",
+    "20380119T031408Z",
+    "21000301T000000Z",
+    "99991231T235959Z",
+  };
+
+  // Timestamps the direct decoder leaves to Datetime.
+  const std::vector <std::string> declined {
+    "",
+    "20160101T080000",
+    "2016-01-01T08:00",
+    "20160101 080000Z",
+    "2016010aT080000Z",
+    "19691231T235959Z",
+    "20161301T000000Z",
+    "20160100T000000Z",
+    "20150229T000000Z",
+    "20160431T000000Z",
+    "20160101T240000Z",
+    "20160101T086000Z",
+    "20160101T080060Z",
+  };
+
+  UnitTest t (plain.size () + corpus.size () + decoded.size () + declined.size () + 2);
+
+  for (auto& line : plain)
+  {
+    Interval interval;
+    t.ok (IntervalFactory::fromSerializationFast (line, interval), "fast path accepts '" + line + "'");
+  }
+
+  for (auto& line : corpus)
+    t.ok (agree (line), "fast path agrees with Lexer on '" + line + "'");
+
+  for (auto& timestamp : decoded)
+  {
+    time_t epoch = -1;
+    t.ok (parseUtcTimestamp (timestamp, epoch) && epoch == Datetime (timestamp).toEpoch (), "decoder agrees with Datetime on '" + timestamp + "'");
+  }
+
+  for (auto& timestamp : declined)
+  {
+    time_t epoch;
+    t.notok (parseUtcTimestamp (timestamp, epoch), "decoder declines '" + timestamp + "'");
+  }
+
+  auto identified = IntervalFactory::fromSerialization ("inc 19700101T000001Z # foo ~0123456789abcdef");
+  t.ok (identified.uid == 0x0123456789abcdefULL, "stable id is parsed");
+  t.is (identified.serialize (), "inc 19700101T000001Z # foo ~0123456789abcdef", "stable id is serialized");
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
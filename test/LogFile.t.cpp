@@ -0,0 +1,130 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <AtomicFile.h>
+#include <FS.h>
+#include <Journal.h>
+#include <LogFile.h>
+#include <TempDir.h>
+#include <string>
+#include <test.h>
+
+////////////////////////////////////////////////////////////////////////////////
+int main (int, char**)
+{
+  UnitTest t (16);
+
+  TempDir tempDir;
+  Path path ("test.log");
+  std::string contents;
+
+  {
+    LogFile log (path);
+    log.append ("abc\n");
+    log.append ("def\n");
+
+    t.is (log.size (), (size_t) 8, "LogFile: size includes pending content");
+    t.is (log.read (2, 4), "c\nde", "LogFile: read returns pending content");
+  }
+
+  t.notok (path.exists (), "LogFile: new file does not exist before finalize");
+  AtomicFile::finalize_all ();
+  File::read (path, contents);
+  t.is (contents, "abc\ndef\n", "LogFile: new file is written on finalize");
+
+  {
+    LogFile log (path);
+    log.truncate (4);
+    log.append ("xyz\n");
+
+    t.is (log.read (2, 4), "c\nxy", "LogFile: read spans file and pending content");
+    t.is (log.read (0, 3), "abc", "LogFile: read returns unchanged content from the file");
+  }
+
+  AtomicFile::finalize_all ();
+  File::read (path, contents);
+  t.is (contents, "abc\nxyz\n", "LogFile: truncate and append replace the end of the file");
+
+  {
+    LogFile log (path);
+    log.truncate (0);
+    t.is (log.size (), (size_t) 0, "LogFile: truncate to zero");
+    log.remove ();
+  }
+
+  AtomicFile::finalize_all ();
+  t.notok (path.exists (), "LogFile: remove deletes the file on finalize");
+
+  {
+    LogFile log (path);
+    log.append ("abc\n");
+    log.append ("def\n");
+    log.truncate (6);
+    log.append ("g\n");
+  }
+
+  AtomicFile::finalize_all ();
+  File::read (path, contents);
+  t.is (contents, "abc\ndeg\n", "LogFile: new file is rewritten after each change");
+  File::remove (path._data);
+
+  {
+    Journal journal;
+    journal.initialize ("undo.data", -1);
+
+    journal.startTransaction ();
+    journal.recordConfigAction ("a", "b");
+    journal.endTransaction ();
+
+    journal.startTransaction ();
+    journal.recordConfigAction ("c", "d");
+    journal.endTransaction ();
+  }
+
+  AtomicFile::finalize_all ();
+
+  {
+    Journal journal;
+    journal.initialize ("undo.data", -1);
+
+    auto actions = journal.popLastTransaction ().getActions ();
+    t.is (actions.size (), (size_t) 1, "LogFile: journal written to a new log has the last transaction");
+    t.is (actions.empty () ? "" : actions[0].getAfter (), "d", "LogFile: journal returns the last transaction");
+
+    actions = journal.popLastTransaction ().getActions ();
+    t.is (actions.size (), (size_t) 1, "LogFile: journal written to a new log has the first transaction");
+    t.is (actions.empty () ? "" : actions[0].getBefore (), "a", "LogFile: journal returns the first transaction");
+
+    t.ok (journal.popLastTransaction ().getActions ().empty (), "LogFile: journal has no more transactions");
+  }
+
+  AtomicFile::finalize_all ();
+  t.notok (File (Path ("undo.data")).exists (), "LogFile: emptied journal is removed");
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,119 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <RangeSet.h>
+#include <cstdlib>
+#include <test.h>
+
+////////////////////////////////////////////////////////////////////////////////
+static Range hours (int from, int to)
+{
+  return Range (Datetime (2020, 1, 1, from, 0, 0), Datetime (2020, 1, 1, to, 0, 0));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Subtracts each range in turn, as subtractRanges used to.
+static std::vector <Range> subtractEach (
+  const Range& range,
+  const std::vector <Range>& subtractions)
+{
+  std::vector <Range> results {range};
+  for (auto& s : subtractions)
+  {
+    std::vector <Range> split;
+    for (auto& r : results)
+      for (auto& piece : r.subtract (s))
+        split.push_back (piece);
+
+    results = split;
+  }
+
+  return results;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int main (int, char**)
+{
+  UnitTest t (12);
+
+  RangeSet a ({hours (4, 6), hours (1, 3), hours (2, 5), hours (8, 9)});
+  t.is (a.size (), (size_t) 2, "RangeSet: overlapping ranges are combined");
+  t.ok (a.ranges ()[0] == hours (1, 6), "RangeSet: ranges are sorted");
+
+  RangeSet touching ({hours (1, 2), hours (2, 3)});
+  t.is (touching.size (), (size_t) 2, "RangeSet: touching ranges are kept apart");
+
+  RangeSet b ({hours (5, 8), hours (10, 11)});
+  auto united = a.unite (b);
+  t.is (united.size (), (size_t) 3, "RangeSet::unite combines across both sets");
+  t.ok (united.ranges ()[0] == hours (1, 8), "RangeSet::unite [1,6) + [5,8) = [1,8)");
+
+  auto intersected = a.intersect (b);
+  t.is (intersected.size (), (size_t) 1, "RangeSet::intersect keeps the common parts");
+  t.ok (intersected.ranges ()[0] == hours (5, 6), "RangeSet::intersect [1,6) * [5,8) = [5,6)");
+
+  auto subtracted = a.subtract (b);
+  t.is (subtracted.size (), (size_t) 2, "RangeSet::subtract leaves two ranges");
+  t.ok (subtracted.ranges ()[0] == hours (1, 5) && subtracted.ranges ()[1] == hours (8, 9),
+        "RangeSet::subtract [1,6) [8,9) - [5,8) [10,11) = [1,5) [8,9)");
+
+  Range open (Datetime (2020, 1, 1, 2, 0, 0), Datetime (0));
+  std::vector <Range> rest;
+  a.outside (open, rest);
+  t.ok (rest.size () == 2 && rest[0] == hours (6, 8) && ! rest[1].is_ended (),
+        "RangeSet::outside of an open range ends open");
+
+  // A zero-width range splits what it is subtracted from, as Range::subtract
+  // does.
+  rest.clear ();
+  RangeSet ({hours (3, 3)}).outside (hours (1, 5), rest);
+  t.is (rest.size (), (size_t) 2, "RangeSet::outside splits at a zero-width range");
+
+  // Compare with subtracting one range at a time, on random ranges.
+  srand (1);
+  bool same = true;
+  for (int round = 0; round < 200 && same; ++round)
+  {
+    std::vector <Range> subtractions;
+    for (int i = 0; i < 8; ++i)
+    {
+      int from = rand () % 20;
+      subtractions.push_back (hours (from, std::min (23, from + rand () % 5)));
+    }
+
+    int from = rand () % 12;
+    auto range = hours (from, from + 1 + rand () % 11);
+
+    std::vector <Range> swept;
+    RangeSet (subtractions).outside (range, swept);
+    same = swept == subtractEach (range, subtractions);
+  }
+  t.ok (same, "RangeSet::outside agrees with Range::subtract");
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,86 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2023, Thomas Lauf, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <FS.h>
+#include <TagCountCache.h>
+#include <TempDir.h>
+#include <fstream>
+#include <string>
+#include <test.h>
+
+////////////////////////////////////////////////////////////////////////////////
+int main (int, char**)
+{
+  UnitTest t (7);
+
+  TempDir tempDir;
+  Path path ("tags.months");
+
+  TagCountCache::counts january {{"bar", 2}, {"foo \"x\"", 1}};
+  TagCountCache::counts february {{"baz", 3}};
+
+  {
+    TagCountCache cache;
+    t.notok (cache.load (path), "TagCountCache: load fails without a file");
+
+    cache.set ("2020-01.data", 100, 1000, january);
+    cache.set ("2020-02.data", 200, 2000, february);
+    t.ok (cache.save (path), "TagCountCache: save");
+  }
+
+  {
+    TagCountCache cache;
+    cache.load (path);
+
+    auto found = cache.find ("2020-01.data", 100, 1000);
+    t.ok (found != nullptr && *found == january, "TagCountCache: counts of a month round-trip");
+    t.ok (cache.find ("2020-01.data", 101, 1000) == nullptr, "TagCountCache: a month of another size is not found");
+    t.ok (cache.find ("2020-02.data", 200, 2001) == nullptr, "TagCountCache: a month of another mtime is not found");
+  }
+
+  {
+    std::string content;
+    File::read (path, content);
+
+    auto pos = content.find ("3 \"baz\"");
+    content[pos] = '4';
+
+    std::ofstream out (path._data, std::ios::out | std::ios::trunc);
+    out << content;
+  }
+
+  {
+    TagCountCache cache;
+    cache.load (path);
+
+    t.ok (cache.find ("2020-01.data", 100, 1000) != nullptr, "TagCountCache: months before a damaged one are kept");
+    t.ok (cache.find ("2020-02.data", 200, 2000) == nullptr, "TagCountCache: a month that does not match its checksum is dropped");
+  }
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -30,7 +30,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 int main (int, char**)
 {
-  UnitTest t (8);
+  UnitTest t (15);
 
   {
     TagInfoDatabase tagInfoDatabase{};
@@ -84,6 +84,44 @@ int main (int, char**)
     }
   }
 
+  {
+    TagInfoDatabase tagInfoDatabase{};
+
+    t.ok (tagInfoDatabase.fromJson ("{\n  \"bar\":{\"count\":1},\n  \"foo \\\"x\\\"\":{\"count\":12}\n}"),
+          "JSON in the layout of toJson is loaded without the JSON parser");
+    t.is (tagInfoDatabase.toJson (),
+          "{\n  \"bar\":{\"count\":1},\n  \"foo \\\"x\\\"\":{\"count\":12}\n}",
+          "JSON loaded without the JSON parser round-trips");
+    t.notok (tagInfoDatabase.fromJson ("{\"foo\":{\"count\":1.5}}"),
+             "JSON with an unexpected count is left to the JSON parser");
+  }
+
+  {
+    TagInfoDatabase tagInfoDatabase{};
+
+    tagInfoDatabase.add ("foo", TagInfo{1});
+    tagInfoDatabase.add ("bar", TagInfo{2});
+    tagInfoDatabase.clear_modified ();
+
+    t.is (tagInfoDatabase.toLog (), "", "No log entries without changes");
+
+    tagInfoDatabase.incrementTag ("foo");
+    tagInfoDatabase.decrementTag ("bar");
+    tagInfoDatabase.decrementTag ("bar");
+    tagInfoDatabase.incrementTag ("new tag");
+
+    t.is (tagInfoDatabase.toLog (),
+          "0 \"bar\"\n2 \"foo\"\n1 \"new tag\"\n",
+          "Log entries hold the new count of every changed tag");
+
+    TagInfoDatabase replayed{};
+    replayed.add ("foo", TagInfo{1});
+    replayed.add ("bar", TagInfo{2});
+
+    t.is ((int) replayed.fromLog (tagInfoDatabase.toLog ()), 3, "All log entries are applied");
+    t.is (replayed.toJson (), tagInfoDatabase.toJson (), "Applying the log restores the changed counts");
+  }
+
   return 0;
 }
 
@@ -195,6 +195,45 @@ class TestChart(TestCase):
 
 """, out)
 
+    def test_chart_year_with_invalid_config_for_max(self):
+        """Chart should report error on invalid value for 'reports.year.max'"""
+        self.t("track for 1h")
+        code, out, err = self.t.runError("year rc.reports.year.max=0")
+
+        self.assertIn("The value for 'reports.year.max' must be at least 1.", err)
+
+    def test_chart_year_shows_tracked_hours_per_day(self):
+        """Chart year should show one glyph per day, scaled by reports.year.max"""
+        self.t("track 2016-01-04T08:00:00 - 2016-01-04T09:00:00 foo")
+        self.t("track 2016-01-05T08:00:00 - 2016-01-05T12:00:00 foo")
+        self.t("track 2016-01-06T08:00:00 - 2016-01-06T15:00:00 foo")
+        self.t("track 2016-01-07T14:00:00 - 2016-01-08T02:00:00 bar")
+
+        code, out, err = self.t("year 2016-01-04 - 2016-01-11")
+
+        self.assertIn("""Mon   -
+Tue   +
+Wed   *
+Thu   #
+Fri   -
+Sat   .
+Sun   .
+
+Legend: . none, - less, + more, * most, # 8 hours or more
+Tracked 24:00:00
+""", out)
+
+    def test_chart_year_with_tags_shows_a_heatmap_per_tag(self):
+        """Chart year with :tags should follow the total with a heatmap per tag, busiest first"""
+        self.t("track 2016-01-04T08:00:00 - 2016-01-04T18:00:00 foo")
+        self.t("track 2016-01-05T08:00:00 - 2016-01-05T09:00:00 bar")
+
+        code, out, err = self.t("year 2016-01-04 - 2016-01-06 :tags")
+
+        self.assertIn("""foo
+2016 Jan""", out)
+        self.assertLess(out.index("\nfoo\n"), out.index("\nbar\n"))
+
 
 if __name__ == "__main__":
     from simpletap import TAPTestRunner
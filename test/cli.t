@@ -86,6 +86,30 @@ class TestCLI(TestCase):
             self.assertIn("BAR", data)
             self.assertEqual(data["BAR"]["count"], 1)
 
+    def test_tag_database_is_recreated_from_unchanged_and_changed_months(self):
+        """Verify that recreating the tag database counts changed months again"""
+        now_utc = datetime.now().utcnow()
+
+        two_hours_before_utc = now_utc - timedelta(hours=2)
+        one_hour_before_utc = now_utc - timedelta(hours=1)
+
+        self.t("track 2016-01-01T08:00:00 - 2016-01-01T09:00:00 FOO")
+        self.t("track 2016-02-01T08:00:00 - 2016-02-01T09:00:00 FOO BAR")
+
+        os.remove(os.path.join(self.t.env["TIMEWARRIORDB"], "data", "tags.data"))
+        self.t.runError("")
+
+        self.t("track 2016-02-02T08:00:00 - 2016-02-02T09:00:00 BAR")
+        self.t("track {:%Y-%m-%dT%H:%M:%S} - {:%Y-%m-%dT%H:%M:%S} FOO".format(two_hours_before_utc, one_hour_before_utc))
+
+        os.remove(os.path.join(self.t.env["TIMEWARRIORDB"], "data", "tags.data"))
+        self.t.runError("")
+
+        with open(os.path.join(self.t.env["TIMEWARRIORDB"], "data", "tags.data")) as f:
+            data = json.load(f)
+            self.assertEqual(data["FOO"]["count"], 3)
+            self.assertEqual(data["BAR"]["count"], 2)
+
     def test_TimeWarrior_without_command_without_active_time_tracking(self):
         """Call 'timew' without active time tracking"""
         code, out, err = self.t.runError()
@@ -148,6 +148,54 @@ class TestDOM(TestCase):
         code, out, err = self.t("get dom.active.json")
         self.assertRegex(out, r'{"id":1,"start":"\d{8}T\d{6}Z","tags":\["foo"\]}')
 
+    def test_dom_active_from_state_file(self):
+        """Test 'dom.active' is read from the state file while the configuration is unchanged"""
+        self.t("start foo")
+        state = os.path.join(self.t.datadir, "data", "state")
+
+        with open(state) as f:
+            lines = f.read().splitlines()
+        self.assertTrue(lines[0].startswith("timew-state 2 1 1"))
+        self.assertIn("tag foo", lines)
+
+        # Only a state file that is used would report this tag.
+        with open(state, "w") as f:
+            f.write("\n".join(lines[:2] + ["interval inc 20200101T000000Z # bar", "tag bar"]) + "\n")
+        code, out, err = self.t("get dom.active.tag.1")
+        self.assertEqual('bar\n', out)
+
+        with open(self.t.timewrc, "a") as f:
+            f.write("verbose = on\n")
+        code, out, err = self.t("get dom.active.tag.1")
+        self.assertEqual('foo\n', out)
+
+    def test_dom_active_from_state_file_with_imported_config(self):
+        """Test 'dom.active' is not read from the state file once an imported file changed"""
+        imported = os.path.join(self.t.datadir, "imported.cfg")
+        with open(imported, "w") as f:
+            f.write("verbose = on\n")
+        with open(self.t.timewrc, "a") as f:
+            f.write("import {}\n".format(imported))
+
+        self.t("start foo")
+        state = os.path.join(self.t.datadir, "data", "state")
+
+        with open(state) as f:
+            lines = f.read().splitlines()
+        self.assertTrue(lines[0].startswith("timew-state 2 1 2"))
+        self.assertTrue(lines[2].endswith(" " + imported))
+
+        # Only a state file that is used would report this tag.
+        with open(state, "w") as f:
+            f.write("\n".join(lines[:3] + ["interval inc 20200101T000000Z # bar", "tag bar"]) + "\n")
+        code, out, err = self.t("get dom.active.tag.1")
+        self.assertEqual('bar\n', out)
+
+        with open(imported, "a") as f:
+            f.write("verbose = off\n")
+        code, out, err = self.t("get dom.active.tag.1")
+        self.assertEqual('foo\n', out)
+
     def test_dom_tracked_count_none(self):
         """Test 'dom.active' without an active interval"""
         code, out, err = self.t("get dom.tracked.count")
@@ -32,7 +32,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 int main (int, char**)
 {
-  UnitTest t (261);
+  UnitTest t (266);
 
   try
   {
@@ -391,6 +391,17 @@ int main (int, char**)
     t.is (ranges[0].end.toISOLocalExtended (),   "2016-05-13T08:00:00", "Exclusion range[0].end()   --> 2016-05-13T08:00:00");
     t.is (ranges[1].start.toISOLocalExtended (), "2016-05-13T12:00:00", "Exclusion range[1].start() --> 2016-05-13T12:00:00");
     t.is (ranges[1].end.toISOLocalExtended (),   "2016-05-13T12:45:00", "Exclusion range[1].end()   --> 2016-05-13T12:45:00");
+
+    // A year, across both changes of daylight saving time. Every block is in
+    // local time, whatever the length of its day.
+    Exclusion e12 ("exclusions.sunday",   "<8:00:00 >17:30:00");
+    Range year {{"20160101T000000"}, {"20170101T000000"}};
+    ranges = e12.ranges (year);
+    t.ok (ranges.size () == 104,                                        "Exclusion ranges --> [104]");
+    t.is (ranges[24].start.toISOLocalExtended (), "2016-03-27T00:00:00", "Exclusion range[24].start() --> 2016-03-27T00:00:00");
+    t.is (ranges[24].end.toISOLocalExtended (),   "2016-03-27T08:00:00", "Exclusion range[24].end()   --> 2016-03-27T08:00:00");
+    t.is (ranges[87].start.toISOLocalExtended (), "2016-10-30T17:30:00", "Exclusion range[87].start() --> 2016-10-30T17:30:00");
+    t.is (ranges[87].end.toISOLocalExtended (),   "2016-10-31T00:00:00", "Exclusion range[87].end()   --> 2016-10-31T00:00:00");
   }
 
   catch (const std::string& e)
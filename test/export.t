@@ -166,6 +166,27 @@ class TestExport(TestCase):
                                 expectedStart="{:%Y%m%dT%H%M%S}Z".format(two_hours_before_utc),
                                 expectedTags=["foo"])
 
+    def test_export_ids_of_open_interval_spanning_several_exclusions(self):
+        """Export the newest synthetic intervals of an open interval spanning several days of exclusions"""
+        now = datetime.now()
+        now_utc = now.utcnow()
+
+        three_hours_before = now - timedelta(hours=3)
+        four_hours_before = now - timedelta(hours=4)
+
+        three_days_before_utc = now_utc - timedelta(days=3, hours=5)
+
+        self.t.configure_exclusions((four_hours_before.time(), three_hours_before.time()))
+
+        self.t("start {:%Y-%m-%dT%H:%M:%S}Z foo".format(three_days_before_utc))
+
+        j = self.t.export()
+        self.assertEqual(len(j), 5)
+
+        k = self.t.export("@1 @2")
+        self.assertEqual(k, j[3:])
+        self.assertOpenInterval(k[1], expectedId=1, expectedTags=["foo"])
+
     def test_export_with_tag_with_spaces(self):
         """Interval with tag with spaces"""
         now_utc = datetime.now().utcnow()
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+
+# Measures how long it takes to durably replace a group of files, as
+# AtomicFile::finalize_all does at the end of every command, with and without
+# batching the syncs:
+#
+#   unbatched  each file is written, synced and renamed, and the directory is
+#              synced, one file after another
+#   batched    all files are written, then all are synced, then all are
+#              renamed, and the directory is synced once
+#
+# Run it against the file system that holds the database, for example:
+#
+#   ./fsync-benchmark.py ~/.local/share/timewarrior/data --files 4
+
+import os
+
+import argparse
+import statistics
+import tempfile
+import time
+
+parser = argparse.ArgumentParser(description='Benchmark fsync latency of grouped file replacements.')
+parser.add_argument('directory', nargs='?', default=tempfile.gettempdir(), help='directory to write the files to')
+parser.add_argument('--files', type=int, default=4, help='number of files replaced per commit')
+parser.add_argument('--size', type=int, default=4096, help='size of each file in bytes')
+parser.add_argument('--rounds', type=int, default=50, help='number of commits to measure')
+
+args = parser.parse_args()
+
+content = os.urandom(args.size)
+
+
+def sync_directory(path):
+    fd = os.open(path, os.O_RDONLY)
+    try:
+        os.fsync(fd)
+    finally:
+        os.close(fd)
+
+
+def write_file(path):
+    fd = os.open(path, os.O_WRONLY | os.O_CREAT | os.O_TRUNC, 0o600)
+    os.write(fd, content)
+    return fd
+
+
+def unbatched(directory, names):
+    for name in names:
+        temp = os.path.join(directory, name + ".tmp")
+        fd = write_file(temp)
+        os.fsync(fd)
+        os.close(fd)
+        os.rename(temp, os.path.join(directory, name))
+        sync_directory(directory)
+
+
+def batched(directory, names):
+    temps = []
+    for name in names:
+        temp = os.path.join(directory, name + ".tmp")
+        temps.append((write_file(temp), temp, os.path.join(directory, name)))
+
+    for fd, _, _ in temps:
+        os.fsync(fd)
+
+    for fd, temp, path in temps:
+        os.close(fd)
+        os.rename(temp, path)
+
+    sync_directory(directory)
+
+
+with tempfile.TemporaryDirectory(prefix="timew-fsync-", dir=args.directory) as directory:
+    names = ["file-{}.data".format(i) for i in range(args.files)]
+
+    print("{} files of {} bytes, {} rounds, in {}".format(args.files, args.size, args.rounds, args.directory))
+    print("{:<10}\t{:>10}\t{:>10}\t{:>10}".format("MODE", "MEDIAN[ms]", "MEAN[ms]", "MAX[ms]"))
+
+    for mode in (unbatched, batched):
+        timings = []
+        for _ in range(args.rounds):
+            start = time.perf_counter()
+            mode(directory, names)
+            timings.append((time.perf_counter() - start) * 1000)
+
+        print("{:<10}\t{:>10.3f}\t{:>10.3f}\t{:>10.3f}".format(mode.__name__,
+                                                               statistics.median(timings),
+                                                               statistics.mean(timings),
+                                                               max(timings)))
@@ -58,10 +58,63 @@ class TestIds(TestCase):
       code, out, err = self.t("move @2 2018-01-03")
       self.assertIn('Moved @2 to 2018-01-03T00:00:00', out)
 
+    def test_ids_across_months(self):
+        """IDs in older months are found after skipping newer months"""
+        self.t("track 2018-01-01T10:00 - 2018-01-01T11:00 foo")
+        self.t("track 2018-02-01T10:00 - 2018-02-01T11:00 bar")
+        self.t("track 2018-02-02T10:00 - 2018-02-02T11:00 baz")
+        self.t("track 2018-03-01T10:00 - 2018-03-01T11:00 qux")
+
+        self.t("tag @2 @4 tagged")
+
+        j = self.t.export()
+        self.assertEqual(len(j), 4)
+        self.assertClosedInterval(j[0], expectedTags=["foo", "tagged"])
+        self.assertClosedInterval(j[1], expectedTags=["bar"])
+        self.assertClosedInterval(j[2], expectedTags=["baz", "tagged"])
+        self.assertClosedInterval(j[3], expectedTags=["qux"])
+
+    def test_should_fail_on_missing_id(self):
+        self.t("track 2018-01-01T10:00 - 2018-01-01T11:00 foo")
+        code, out, err = self.t.runError("delete @3")
+        self.assertIn("ID '@3' does not correspond to any tracking.", err)
+
     def test_should_fail_on_zero_id(self):
         code, out, err = self.t.runError("delete @0")
         self.assertIn("'@0' is not a valid ID.", err)
 
+    def test_stable_id_follows_interval(self):
+        """A stable ID names the same interval after intervals are added before it"""
+        self.t.config("ids.stable", "on")
+        self.t("track 2018-02-01T10:00 - 2018-02-01T11:00 foo")
+        uid = self.t.export()[0]["uid"]
+
+        self.t("track 2018-01-01T10:00 - 2018-01-01T11:00 bar")
+        self.t("track 2018-03-01T10:00 - 2018-03-01T11:00 baz")
+        self.t("tag @#{} tagged".format(uid))
+
+        j = self.t.export("@#{}".format(uid))
+        self.assertEqual(len(j), 1)
+        self.assertClosedInterval(j[0], expectedId=2, expectedTags=["foo", "tagged"])
+        self.assertEqual(j[0]["uid"], uid)
+
+    def test_stable_id_kept_on_move(self):
+        """A moved interval keeps its stable ID"""
+        self.t.config("ids.stable", "on")
+        self.t("track 2018-01-01T10:00:00Z - 2018-01-01T11:00:00Z foo")
+        uid = self.t.export()[0]["uid"]
+
+        self.t("move @#{} 2018-02-01T10:00:00Z".format(uid))
+
+        j = self.t.export("@#{}".format(uid))
+        self.assertEqual(len(j), 1)
+        self.assertClosedInterval(j[0], expectedStart="20180201T100000Z", expectedTags=["foo"])
+
+    def test_should_fail_on_missing_stable_id(self):
+        self.t("track 2018-01-01T10:00 - 2018-01-01T11:00 foo")
+        code, out, err = self.t.runError("delete @#0123456789abcdef")
+        self.assertIn("'@#0123456789abcdef' does not correspond to any tracking.", err)
+
 
 if __name__ == "__main__":
     from simpletap import TAPTestRunner
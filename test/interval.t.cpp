@@ -26,12 +26,13 @@
 
 #include <Interval.h>
 #include <IntervalFactory.h>
+#include <TagDictionary.h>
 #include <test.h>
 
 ////////////////////////////////////////////////////////////////////////////////
 int main (int, char**)
 {
-  UnitTest t (64);
+  UnitTest t (72);
 
   // bool is_started () const;
   // bool is_ended () const;
@@ -261,6 +262,25 @@ int main (int, char**)
   i22.tag ("foo_bar");
   t.is (i22.serialize (), "inc # \"foo_bar\"", "Interval().serialize -> 'inc # \"foo_bar\"'");
 
+  // Tags are held as ids, independent of the order they were added in.
+  Interval i23;
+  i23.tag ("zulu");
+  i23.tag ("alpha");
+  Interval i24;
+  i24.tag ("alpha");
+  i24.tag ("zulu");
+  t.ok (i23 == i24, "Interval tags do not depend on order");
+  t.is (i23.serialize (), "inc # alpha zulu", "Interval().serialize sorts tags by name");
+  t.ok (i23.hasTags (TagDictionary::ids ({"zulu"})), "hasTags positive");
+  t.notok (i23.hasTags (TagDictionary::ids ({"zulu", "bar"})), "hasTags negative");
+
+  // Looking for a tag does not add it to the dictionary.
+  auto known = TagDictionary::size ();
+  t.notok (i23.hasTag ("never-used"), "hasTag of an unknown tag");
+  t.ok (TagDictionary::lookup ("never-used") == TagDictionary::none, "TagDictionary::lookup of an unknown tag");
+  t.is (TagDictionary::size (), known, "TagDictionary::lookup does not add tags");
+  t.ok (TagDictionary::lookup ("zulu") == TagDictionary::id ("zulu"), "TagDictionary::lookup of a known tag");
+
 
 
   return 0;
@@ -142,6 +142,14 @@ function test_performance_month()
   ${TIMEW_BIN} delete @1 >/dev/null
 }
 
+function test_performance_month-year()
+{
+  # test
+  ( ( time -p (
+      ${TIMEW_BIN} month :year >/dev/null
+  ) 2>&1 >/dev/null ) | awk '{a[NR]=$2}; END {for(i=1;i<=3;i++){printf "%s\t",a[i]}}')
+}
+
 function test_performance_modify-end()
 {
   # setup
@@ -309,6 +317,14 @@ function test_performance_week()
   ${TIMEW_BIN} delete @1 >/dev/null
 }
 
+function test_performance_year()
+{
+  # test
+  ( ( time -p (
+      ${TIMEW_BIN} year :all >/dev/null
+  ) 2>&1 >/dev/null ) | awk '{a[NR]=$2}; END {for(i=1;i<=3;i++){printf "%s\t",a[i]}}')
+}
+
 OUTPUT_DIR="${1-/tmp/timew-performance}"
 
 export TIMEWARRIORDB=/tmp/timewarriordb
@@ -319,7 +335,7 @@ rm -f ${TIMEWARRIORDB}/data/*.data
 mkdir -p "${OUTPUT_DIR}"
 rm -rf "${OUTPUT_DIR:?}"/*
 
-TIMEW_COMMANDS="annotate cancel continue day delete export gaps get join lengthen modify-end modify-start month move resize shorten split start stop summary tag tags track undo untag week"
+TIMEW_COMMANDS="annotate cancel continue day delete export gaps get join lengthen modify-end modify-start month month-year move resize shorten split start stop summary tag tags track undo untag week year"
 
 # Write headers
 for timew_cmd in ${TIMEW_COMMANDS} ; do
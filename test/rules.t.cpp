@@ -30,7 +30,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 int main (int, char**)
 {
-  UnitTest t (8);
+  UnitTest t (10);
 
   Rules r;
   r.set ("string", "234");
@@ -54,6 +54,12 @@ int main (int, char**)
   t.ok ((int) r.all ().size () > 30,     "Rules all (\"\") --> >30");
   t.ok (r.all ("one.two").size () == 3,  "Rules all (\"one.two\") --> 3");
 
+  auto generation = r.generation ();
+  Rules other;
+  t.ok (other.generation () != generation, "Rules generation differs between instances");
+  r.set ("one.two", 21);
+  t.ok (r.generation () != generation,     "Rules generation changes with a setting");
+
   return 0;
 }
 
@@ -157,6 +157,23 @@ W10 2017-03-10 Fri @2      10:00:00 11:00:00 1:00:00 1:00:00
                                                      1:00:00
 """, out)
 
+    def test_with_date_filter_in_earlier_month(self):
+        """Summary should number intervals correctly when later months are skipped"""
+        self.t("track 2017-03-10T10:00:00 - 2017-03-10T11:00:00")
+        self.t("track 2017-04-10T10:00:00 - 2017-04-10T11:00:00")
+        self.t("track 2017-05-10T10:00:00 - 2017-05-10T11:00:00")
+        self.t("track 2017-05-11T10:00:00 - 2017-05-11T11:00:00")
+
+        code, out, err = self.t("summary 2017-03-10 :ids")
+
+        self.assertIn("""
+Wk  Date       Day ID Tags    Start      End    Time   Total
+--- ---------- --- -- ---- -------- -------- ------- -------
+W10 2017-03-10 Fri @4      10:00:00 11:00:00 1:00:00 1:00:00
+
+                                                     1:00:00
+""", out)
+
     def test_with_tag_filter(self):
         """Summary should print data filtered by tag"""
         self.t("track Tag1 2017-03-09T08:43:08 - 2017-03-09T09:38:15")
@@ -72,6 +72,20 @@ class TestTags(TestCase):
         self.assertNotIn('foo', out)
         self.assertIn('bar', out)
 
+    def test_tags_of_new_database_are_kept_in_tags_log(self):
+        """Test that the tags log started by the first tag change of a new database is read back"""
+        self.t("track 20160101T0100 - 20160101T1000 foo")
+        self.t("track 20160104T0100 - 20160104T1000 bar")
+
+        code, out, err = self.t("tags")
+
+        self.assertIn('foo', out)
+        self.assertIn('bar', out)
+        self.assertNotIn('Error parsing tags database', err)
+
+        with open(os.path.join(self.t.datadir, "data", "tags.log")) as f:
+            self.assertEqual(f.read().count("checkpoint "), 1)
+
 
 class TestTagFeedback(TestCase):
     def setUp(self):
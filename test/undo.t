@@ -545,6 +545,35 @@ class TestUndo(TestCase):
                                   expectedEnd=one_hour_before_utc,
                                   expectedTags=["foo"])
 
+    def test_undo_tag_many(self):
+        """Test undo of command 'tag' with several ids"""
+        now_utc = datetime.now().utcnow()
+        one_hour_before_utc = now_utc - timedelta(hours=1)
+        two_hours_before_utc = now_utc - timedelta(hours=2)
+        three_hours_before_utc = now_utc - timedelta(hours=3)
+
+        self.t("track {:%Y%m%dT%H%M%SZ} - {:%Y%m%dT%H%M%SZ} foo".format(three_hours_before_utc, two_hours_before_utc))
+        self.t("track {:%Y%m%dT%H%M%SZ} - {:%Y%m%dT%H%M%SZ} foo".format(two_hours_before_utc, one_hour_before_utc))
+        self.t("tag @1 @2 bar")
+
+        j = self.t.export()
+        self.assertEqual(len(j), 2, msg="Expected 2 intervals before, got {}".format(len(j)))
+        self.assertClosedInterval(j[0], expectedTags=["bar", "foo"])
+        self.assertClosedInterval(j[1], expectedTags=["bar", "foo"])
+
+        self.t("undo")
+
+        j = self.t.export()
+        self.assertEqual(len(j), 2, msg="Expected 2 intervals afterwards, got {}".format(len(j)))
+        self.assertClosedInterval(j[0],
+                                  expectedStart=three_hours_before_utc,
+                                  expectedEnd=two_hours_before_utc,
+                                  expectedTags=["foo"])
+        self.assertClosedInterval(j[1],
+                                  expectedStart=two_hours_before_utc,
+                                  expectedEnd=one_hour_before_utc,
+                                  expectedTags=["foo"])
+
     def test_undo_track(self):
         """Test undo of command 'track'"""
         now_utc = datetime.now().utcnow()
@@ -703,6 +732,39 @@ class TestUndo(TestCase):
         self.t("undo")
         self.assertEqual(before_a, self.t.export())
 
+    def test_undo_journal_size_three_after_many_entries(self):
+        """Test undo only stores three entries after the journal was trimmed repeatedly"""
+
+        self.t("config journal.size 3 :yes")
+        exports = []
+        for hours in range(16, 6, -1):
+            exports.append(self.t.export())
+            self.t("start {}h ago proj{}".format(hours, hours))
+
+        self.t("undo")
+        self.assertEqual(exports[-1], self.t.export())
+        self.t("undo")
+        self.assertEqual(exports[-2], self.t.export())
+        self.t("undo")
+        self.t("undo") # This undo should not have any effect
+        self.assertEqual(exports[-3], self.t.export())
+
+    def test_undo_without_journal_index(self):
+        """Test undo rebuilds a missing journal index"""
+
+        self.t("start 16h ago proja")
+        before_b = self.t.export()
+        self.t("start 15h ago projb")
+        before_c = self.t.export()
+        self.t("start 14h ago projc")
+
+        os.remove(os.path.join(self.t.env["TIMEWARRIORDB"], "data", "undo.idx"))
+
+        self.t("undo")
+        self.assertEqual(before_c, self.t.export())
+        self.t("undo")
+        self.assertEqual(before_b, self.t.export())
+
     def test_undo_process_commands_when_disabled(self):
         """Test that disabling the journal clears it."""
 